@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+
+#include "Ecs.hh"
+
+namespace bench
+{
+	struct Position
+	{
+		Position() {}
+		Position(float x, float y, float z) : x(x), y(y), z(z) {}
+		float x, y, z;
+	};
+
+	struct Velocity
+	{
+		Velocity() {}
+		Velocity(float dx, float dy, float dz) : dx(dx), dy(dy), dz(dz) {}
+		float dx, dy, dz;
+	};
+
+	struct Health
+	{
+		Health() {}
+		Health(int value) : value(value) {}
+		int value;
+	};
+
+	struct Damage
+	{
+		Damage(int amount) : amount(amount) {}
+		int amount;
+	};
+
+	// 32 bit entities only have 22 index bits so they can't hold 10M entities
+	const int64_t MAX_ENTITIES = std::min<int64_t>(10000000,
+		static_cast<int64_t>(ecs::Entity::Id::INDEX_MASK) - 1);
+
+	/**
+	 * Entity counts that most benchmarks are run with: 1K, 10K, ... up to 10M
+	 */
+	inline void EntityCounts(benchmark::internal::Benchmark *b)
+	{
+		for (int64_t count = 1000; count <= MAX_ENTITIES; count *= 10)
+		{
+			b->Arg(count);
+		}
+		b->Unit(benchmark::kMicrosecond);
+	}
+
+	template <size_t N>
+	struct Filler
+	{
+		int value;
+	};
+
+	template <size_t ...Ns>
+	inline void registerFillerTypes(ecs::EntityManager &em, ecs::IndexSequence<Ns...>)
+	{
+		int unused[] = { (em.RegisterComponentType<Filler<Ns> >(), 0)... };
+		(void)unused;
+	}
+
+	/**
+	 * Register 32 unrelated component types, like an application with many
+	 * component types that aren't involved in the benchmark
+	 */
+	inline void RegisterFillerTypes(ecs::EntityManager &em)
+	{
+		registerFillerTypes(em, ecs::MakeIndexSequence<32>::type());
+	}
+
+	/**
+	 * Create @count entities that each have a Position and every @velocityEvery'th
+	 * of them also has a Velocity.
+	 */
+	inline void Populate(ecs::EntityManager &em, int64_t count, int64_t velocityEvery = 1)
+	{
+		em.RegisterComponentType<Position>();
+		em.RegisterComponentType<Velocity>();
+
+		for (int64_t i = 0; i < count; ++i)
+		{
+			ecs::Entity e = em.NewEntity();
+			e.Assign<Position>(0.f, 0.f, 0.f);
+			if (i % velocityEvery == 0)
+			{
+				e.Assign<Velocity>(1.f, 1.f, 1.f);
+			}
+		}
+	}
+}
@@ -0,0 +1,265 @@
+#include "Common.hh"
+
+namespace bench
+{
+	// same as Position but stored in fixed-size chunks instead of a single vector
+	struct ChunkedPosition : Position
+	{
+		ChunkedPosition(float x, float y, float z) : Position(x, y, z) {}
+	};
+}
+
+namespace ecs
+{
+	template <>
+	struct StorageTraits<bench::ChunkedPosition> : DefaultStorageTraits
+	{
+		static constexpr ComponentLayout layout = ComponentLayout::Chunked;
+	};
+}
+
+namespace bench
+{
+	template <typename PositionType>
+	static void BM_AssignComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		vector<ecs::Entity> entities;
+		entities.reserve(count);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			em->RegisterComponentType<PositionType>();
+			entities.clear();
+			for (int64_t i = 0; i < count; ++i)
+			{
+				entities.push_back(em->NewEntity());
+			}
+			state.ResumeTiming();
+
+			for (ecs::Entity &e : entities)
+			{
+				benchmark::DoNotOptimize(e.Assign<PositionType>(1.f, 2.f, 3.f));
+			}
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK_TEMPLATE(BM_AssignComponent, Position)->Apply(EntityCounts);
+	BENCHMARK_TEMPLATE(BM_AssignComponent, ChunkedPosition)->Apply(EntityCounts);
+
+	/**
+	 * Same as BM_AssignComponent except the components are recorded in a
+	 * CommandBuffer and then flushed
+	 */
+	static void BM_CommandBufferAssignComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		vector<ecs::Entity> entities;
+		entities.reserve(count);
+		ecs::CommandBuffer buffer;
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			em->RegisterComponentType<Position>();
+			entities.clear();
+			for (int64_t i = 0; i < count; ++i)
+			{
+				entities.push_back(em->NewEntity());
+			}
+			state.ResumeTiming();
+
+			for (ecs::Entity &e : entities)
+			{
+				buffer.Assign<Position>(e.GetId(), 1.f, 2.f, 3.f);
+			}
+			em->Flush(buffer);
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_CommandBufferAssignComponent)->Apply(EntityCounts);
+
+	/**
+	 * A component that owns heap memory so each extra copy made while assigning
+	 * it costs an allocation
+	 */
+	struct Mesh
+	{
+		Mesh(size_t vertexCount) : vertices(vertexCount, 1.f) {}
+		vector<float> vertices;
+	};
+
+	template <bool Emplace>
+	static void BM_AssignHeapComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		vector<ecs::Entity> entities;
+		entities.reserve(count);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			em->RegisterComponentType<Mesh>();
+			entities.clear();
+			for (int64_t i = 0; i < count; ++i)
+			{
+				entities.push_back(em->NewEntity());
+			}
+			state.ResumeTiming();
+
+			for (ecs::Entity &e : entities)
+			{
+				if (Emplace)
+				{
+					benchmark::DoNotOptimize(e.Emplace<Mesh>(64));
+				}
+				else
+				{
+					Mesh mesh(64);
+					benchmark::DoNotOptimize(e.Assign<Mesh>(mesh));
+				}
+			}
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK_TEMPLATE(BM_AssignHeapComponent, false)->Apply(EntityCounts);
+	BENCHMARK_TEMPLATE(BM_AssignHeapComponent, true)->Apply(EntityCounts);
+
+	static void BM_RemoveComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		vector<ecs::Entity> entities;
+		entities.reserve(count);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			entities.clear();
+			for (int64_t i = 0; i < count; ++i)
+			{
+				entities.push_back(em->NewEntity());
+				entities.back().Assign<Position>(1.f, 2.f, 3.f);
+			}
+			state.ResumeTiming();
+
+			for (ecs::Entity &e : entities)
+			{
+				e.Remove<Position>();
+			}
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_RemoveComponent)->Apply(EntityCounts);
+
+	/**
+	 * Same as BM_RemoveComponent with a component that owns heap memory, every
+	 * removal moves the pool's last component into the removed one's place
+	 */
+	static void BM_RemoveHeapComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		vector<ecs::Entity> entities;
+		entities.reserve(count);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			entities.clear();
+			for (int64_t i = 0; i < count; ++i)
+			{
+				entities.push_back(em->NewEntity());
+				entities.back().Emplace<Mesh>(64);
+			}
+			state.ResumeTiming();
+
+			for (ecs::Entity &e : entities)
+			{
+				e.Remove<Mesh>();
+			}
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_RemoveHeapComponent)->Apply(EntityCounts);
+
+	static void BM_HandleDereference(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		vector<ecs::Handle<Position> > handles;
+		handles.reserve(count);
+
+		for (int64_t i = 0; i < count; ++i)
+		{
+			handles.push_back(em.NewEntity().Assign<Position>(1.f, 2.f, 3.f));
+		}
+
+		for (auto _ : state)
+		{
+			for (auto &handle : handles)
+			{
+				handle->x += 1.f;
+			}
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_HandleDereference)->Apply(EntityCounts);
+
+	static void BM_EntityGetComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		entities.reserve(count);
+
+		for (int64_t i = 0; i < count; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			entities.back().Assign<Position>(1.f, 2.f, 3.f);
+		}
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity &e : entities)
+			{
+				e.Get<Position>()->x += 1.f;
+			}
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EntityGetComponent)->Apply(EntityCounts);
+}
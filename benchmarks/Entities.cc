@@ -0,0 +1,237 @@
+#include "Common.hh"
+
+namespace bench
+{
+	static void BM_NewEntity(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			state.ResumeTiming();
+
+			for (int64_t i = 0; i < count; ++i)
+			{
+				benchmark::DoNotOptimize(em->NewEntity());
+			}
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_NewEntity)->Apply(EntityCounts);
+
+	static void BM_NewEntities(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(em->NewEntities(count));
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_NewEntities)->Apply(EntityCounts);
+
+	/**
+	 * Same as BM_NewEntity with the entities reserved, as worker threads would,
+	 * and then made valid all at once
+	 */
+	static void BM_ReserveEntity(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			state.ResumeTiming();
+
+			for (int64_t i = 0; i < count; ++i)
+			{
+				benchmark::DoNotOptimize(em->ReserveEntity());
+			}
+			em->FlushReservedEntities();
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_ReserveEntity)->Apply(EntityCounts);
+
+	/**
+	 * Spawn entities with 2 components one at a time
+	 */
+	static void BM_SpawnWithComponents(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			state.ResumeTiming();
+
+			for (int64_t i = 0; i < count; ++i)
+			{
+				ecs::Entity e = em->NewEntity();
+				e.Assign<Position>(0.f, 0.f, 0.f);
+				e.Assign<Velocity>(1.f, 1.f, 1.f);
+			}
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_SpawnWithComponents)->Apply(EntityCounts);
+
+	static void BM_CreateMany(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(em->CreateMany(count,
+				Position(0.f, 0.f, 0.f), Velocity(1.f, 1.f, 1.f)));
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_CreateMany)->Apply(EntityCounts);
+
+	static void BM_DestroyEntity(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		vector<ecs::Entity::Id> ids;
+		ids.reserve(count);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			Populate(*em, count, 2);
+			ids.clear();
+			for (ecs::Entity e : em->EntitiesWith<Position>())
+			{
+				ids.push_back(e.GetId());
+			}
+			state.ResumeTiming();
+
+			for (ecs::Entity::Id id : ids)
+			{
+				em->Destroy(id);
+			}
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_DestroyEntity)->Apply(EntityCounts);
+
+	/**
+	 * Replace every entity with a new one, ex. short lived bullets. Enough
+	 * indexes are already free that each new entity reuses one.
+	 */
+	static void BM_RecycleEntity(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		em.NewEntities(ECS_ENTITY_RECYCLE_COUNT);
+		em.DestroyAll();
+		vector<ecs::Entity::Id> ids = em.NewEntities(count);
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity::Id &id : ids)
+			{
+				em.Destroy(id);
+				id = em.NewEntity().GetId();
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_RecycleEntity)->Apply(EntityCounts);
+
+	static void BM_DestroyBatch(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		vector<ecs::Entity::Id> ids;
+		ids.reserve(count);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			Populate(*em, count, 2);
+			ids.clear();
+			for (ecs::Entity e : em->EntitiesWith<Position>())
+			{
+				ids.push_back(e.GetId());
+			}
+			state.ResumeTiming();
+
+			em->DestroyBatch(ids);
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_DestroyBatch)->Apply(EntityCounts);
+
+	static void BM_DestroyAll(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			unique_ptr<ecs::EntityManager> em(new ecs::EntityManager());
+			Populate(*em, count, 2);
+			state.ResumeTiming();
+
+			em->DestroyAll();
+
+			state.PauseTiming();
+			em.reset();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_DestroyAll)->Apply(EntityCounts);
+}
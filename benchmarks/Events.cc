@@ -0,0 +1,224 @@
+#include "Common.hh"
+
+namespace bench
+{
+	/**
+	 * Emit an entity event to a varying number of subscribers of that event type
+	 */
+	static void BM_EmitFanOut(benchmark::State &state)
+	{
+		const int64_t subscribers = state.range(0);
+		ecs::EntityManager em;
+		ecs::Entity e = em.NewEntity();
+
+		int64_t total = 0;
+		for (int64_t i = 0; i < subscribers; ++i)
+		{
+			em.Subscribe<Damage>([&total](ecs::Entity, const Damage &d) {
+				total += d.amount;
+			});
+		}
+
+		for (auto _ : state)
+		{
+			e.Emit(Damage(1));
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_EmitFanOut)->RangeMultiplier(4)->Range(0, 256);
+
+	/**
+	 * Emit an event on an entity that has its own entity-specific subscriber
+	 */
+	static void BM_EmitEntitySubscriber(benchmark::State &state)
+	{
+		ecs::EntityManager em;
+		ecs::Entity e = em.NewEntity();
+
+		int64_t total = 0;
+		e.Subscribe<Damage>([&total](ecs::Entity, const Damage &d) {
+			total += d.amount;
+		});
+
+		for (auto _ : state)
+		{
+			e.Emit(Damage(1));
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_EmitEntitySubscriber);
+
+	/**
+	 * Emit an event on each of many entities that all have their own subscriber
+	 */
+	static void BM_EmitManyEntitySubscribers(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.NewEntities(count);
+
+		int64_t total = 0;
+		for (ecs::Entity::Id e : ids)
+		{
+			em.Subscribe<Damage>([&total](ecs::Entity, const Damage &d) {
+				total += d.amount;
+			}, e);
+		}
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity::Id e : ids)
+			{
+				em.Emit(e, Damage(1));
+			}
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EmitManyEntitySubscribers)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+	/**
+	 * Emit a non-entity event to a varying number of subscribers
+	 */
+	static void BM_EmitNonEntityFanOut(benchmark::State &state)
+	{
+		const int64_t subscribers = state.range(0);
+		ecs::EntityManager em;
+
+		int64_t total = 0;
+		for (int64_t i = 0; i < subscribers; ++i)
+		{
+			em.Subscribe<Damage>([&total](const Damage &d) {
+				total += d.amount;
+			});
+		}
+
+		for (auto _ : state)
+		{
+			em.Emit(Damage(1));
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_EmitNonEntityFanOut)->RangeMultiplier(4)->Range(0, 256);
+
+	/**
+	 * Emit one event per entity to a single subscriber, the baseline for
+	 * BM_EnqueueDispatch and BM_EnqueueDispatchBatch
+	 */
+	static void BM_EmitPerEntity(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.NewEntities(count);
+
+		int64_t total = 0;
+		em.Subscribe<Damage>([&total](ecs::Entity, const Damage &d) {
+			total += d.amount;
+		});
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity::Id e : ids)
+			{
+				em.Emit(e, Damage(1));
+			}
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EmitPerEntity)->Apply(EntityCounts);
+
+	/**
+	 * Queue one event per entity and dispatch them to a single subscriber
+	 */
+	static void BM_EnqueueDispatch(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.NewEntities(count);
+
+		int64_t total = 0;
+		em.Subscribe<Damage>([&total](ecs::Entity, const Damage &d) {
+			total += d.amount;
+		});
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity::Id e : ids)
+			{
+				em.Enqueue(e, Damage(1));
+			}
+			em.DispatchQueued<Damage>();
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EnqueueDispatch)->Apply(EntityCounts);
+
+	/**
+	 * Queue one event per entity and dispatch them to a batch subscriber
+	 */
+	static void BM_EnqueueDispatchBatch(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.NewEntities(count);
+
+		int64_t total = 0;
+		em.SubscribeBatch<Damage>([&total](ecs::Span<const std::pair<ecs::Entity, Damage>> events) {
+			for (auto &event : events)
+			{
+				total += event.second.amount;
+			}
+		});
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity::Id e : ids)
+			{
+				em.Enqueue(e, Damage(1));
+			}
+			em.DispatchQueued<Damage>();
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EnqueueDispatchBatch)->Apply(EntityCounts);
+
+	/**
+	 * Emit an event per entity from ParallelEach(), they are staged per thread
+	 * and delivered when it returns
+	 */
+	static void BM_ParallelEachEmit(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count, 1);
+
+		int64_t total = 0;
+		em.Subscribe<Damage>([&total](ecs::Entity, const Damage &d) {
+			total += d.amount;
+		});
+
+		for (auto _ : state)
+		{
+			em.ParallelEach<Position>([](ecs::Entity e, Position &) {
+				e.Emit(Damage(1));
+			});
+		}
+		benchmark::DoNotOptimize(total);
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_ParallelEachEmit)->Apply(EntityCounts);
+}
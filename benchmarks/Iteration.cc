@@ -0,0 +1,363 @@
+#include "Common.hh"
+
+namespace bench
+{
+	// same as Position but stored as a struct of arrays
+	struct SoaPosition : Position
+	{
+		SoaPosition(float x, float y, float z) : Position(x, y, z) {}
+	};
+
+	// same as Position but stamped with the change tick whenever it's accessed mutably
+	struct TrackedPosition : Position
+	{
+		TrackedPosition(float x, float y, float z) : Position(x, y, z) {}
+	};
+}
+
+namespace ecs
+{
+	template <>
+	struct StorageTraits<bench::SoaPosition> : DefaultStorageTraits
+	{
+		static constexpr ComponentLayout layout = ComponentLayout::StructOfArrays;
+	};
+
+	template <>
+	struct StorageTraits<bench::TrackedPosition> : DefaultStorageTraits
+	{
+		static constexpr bool trackChanges = true;
+	};
+
+	template <>
+	struct SoaFields<bench::SoaPosition>
+	{
+		static std::tuple<float bench::Position::*, float bench::Position::*, float bench::Position::*> Members()
+		{
+			return std::make_tuple(&bench::Position::x, &bench::Position::y, &bench::Position::z);
+		}
+	};
+}
+
+namespace bench
+{
+	static void BM_EntitiesWithOneComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count);
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity e : em.EntitiesWith<Position>())
+			{
+				e.Get<Position>()->x += 1.f;
+			}
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EntitiesWithOneComponent)->Apply(EntityCounts);
+
+	static void BM_EntitiesWithTwoComponents(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count);
+
+		for (auto _ : state)
+		{
+			for (ecs::Entity e : em.EntitiesWith<Position, Velocity>())
+			{
+				auto position = e.Get<Position>();
+				auto velocity = e.Get<Velocity>();
+				position->x += velocity->dx;
+				position->y += velocity->dy;
+				position->z += velocity->dz;
+			}
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EntitiesWithTwoComponents)->Apply(EntityCounts);
+
+	static void BM_EachTwoComponents(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count);
+
+		for (auto _ : state)
+		{
+			em.Each<Position, Velocity>([](ecs::Entity, Position &position, Velocity &velocity)
+			{
+				position.x += velocity.dx;
+				position.y += velocity.dy;
+				position.z += velocity.dz;
+			});
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EachTwoComponents)->Apply(EntityCounts);
+
+	static void BM_EachOneComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count);
+
+		for (auto _ : state)
+		{
+			em.Each<Position>([](ecs::Entity, Position &position)
+			{
+				position.x *= 0.5f;
+				position.y *= 0.5f;
+				position.z *= 0.5f;
+			});
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_EachOneComponent)->Apply(EntityCounts);
+
+	/**
+	 * Same as BM_EachOneComponent with the component stored as a struct of arrays
+	 * and updated one column at a time
+	 */
+	static void BM_ColumnsOneComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		for (int64_t i = 0; i < count; ++i)
+		{
+			em.NewEntity().Assign<SoaPosition>(1.f, 2.f, 3.f);
+		}
+		auto positions = em.Columns<SoaPosition>();
+
+		for (auto _ : state)
+		{
+			for (ecs::Span<float> column : { positions.Column<0>(), positions.Column<1>(), positions.Column<2>() })
+			{
+				for (float &value : column)
+				{
+					value *= 0.5f;
+				}
+			}
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_ColumnsOneComponent)->Apply(EntityCounts);
+
+	/**
+	 * Only 1 in 100 components changed since the last time, ex. a system that sends
+	 * the positions that moved over the network, compare with BM_EachOneComponent
+	 */
+	static void BM_EachChangedOneComponent(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int64_t i = 0; i < count; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			entities.back().Assign<TrackedPosition>(1.f, 2.f, 3.f);
+		}
+
+		uint64 since = em.AdvanceChangeTick();
+		for (int64_t i = 0; i < count; i += 100)
+		{
+			entities[i].Get<TrackedPosition>()->x = 0.f;
+		}
+
+		int64_t matches = 0;
+		for (auto _ : state)
+		{
+			em.Each<TrackedPosition>(ecs::Changed<TrackedPosition>(since),
+				[&matches](ecs::Entity, TrackedPosition &position)
+			{
+				position.y *= 0.5f;
+				matches++;
+			});
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+		state.counters["matches"] = static_cast<double>(matches) / state.iterations();
+	}
+	BENCHMARK(BM_EachChangedOneComponent)->Apply(EntityCounts);
+
+	static void BM_QueryEachTwoComponents(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count);
+		auto query = em.CreateQuery<Position, Velocity>();
+
+		for (auto _ : state)
+		{
+			query.Each([](ecs::Entity, Position &position, Velocity &velocity)
+			{
+				position.x += velocity.dx;
+				position.y += velocity.dy;
+				position.z += velocity.dz;
+			});
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_QueryEachTwoComponents)->Apply(EntityCounts);
+
+	/**
+	 * Cost of setting up an iteration when there are many registered component types
+	 * and no entities match, ex. a system that runs every frame but rarely has work
+	 */
+	static void BM_EachSetup(benchmark::State &state)
+	{
+		ecs::EntityManager em;
+		RegisterFillerTypes(em);
+		em.RegisterComponentType<Position>();
+		em.RegisterComponentType<Velocity>();
+
+		for (auto _ : state)
+		{
+			em.Each<Position, Velocity>([](ecs::Entity, Position &, Velocity &) {});
+		}
+	}
+	BENCHMARK(BM_EachSetup);
+
+	static void BM_QueryEachSetup(benchmark::State &state)
+	{
+		ecs::EntityManager em;
+		RegisterFillerTypes(em);
+		auto query = em.CreateQuery<Position, Velocity>();
+
+		for (auto _ : state)
+		{
+			query.Each([](ecs::Entity, Position &, Velocity &) {});
+		}
+	}
+	BENCHMARK(BM_QueryEachSetup);
+
+	/**
+	 * Same as BM_EachTwoComponents split across a varying number of worker threads
+	 */
+	static void BM_ParallelEachTwoComponents(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		em.SetWorkerThreadCount(state.range(1));
+		Populate(em, count);
+
+		for (auto _ : state)
+		{
+			em.ParallelEach<Position, Velocity>([](ecs::Entity, Position &position, Velocity &velocity)
+			{
+				position.x += velocity.dx;
+				position.y += velocity.dy;
+				position.z += velocity.dz;
+			}, 4096);
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK(BM_ParallelEachTwoComponents)
+		->ArgsProduct({ { 100000, 1000000 }, { 0, 1, 3, 7 } })
+		->ArgNames({ "entities", "workers" })
+		->Unit(benchmark::kMicrosecond)
+		->UseRealTime();
+
+	/**
+	 * Only 1 in 10 entities with a Position also has a Velocity, but the Velocity
+	 * pool is not the smallest so most candidate entities get filtered out.
+	 */
+	static void BM_EntitiesWithSparseMatches(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count, 10);
+
+		// make Velocity the larger pool so Position drives the iteration
+		for (int64_t i = 0; i < count; ++i)
+		{
+			em.NewEntity().Assign<Velocity>(1.f, 1.f, 1.f);
+		}
+
+		int64_t matches = 0;
+		for (auto _ : state)
+		{
+			for (ecs::Entity e : em.EntitiesWith<Position, Velocity>())
+			{
+				benchmark::DoNotOptimize(e);
+				matches++;
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+		state.counters["matches"] = static_cast<double>(matches) / state.iterations();
+	}
+	BENCHMARK(BM_EntitiesWithSparseMatches)->Apply(EntityCounts);
+
+	static void BM_EntitiesWithSparseMatchesGrouped(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count, 10);
+
+		for (int64_t i = 0; i < count; ++i)
+		{
+			em.NewEntity().Assign<Velocity>(1.f, 1.f, 1.f);
+		}
+		em.RegisterComponentGroup<Position, Velocity>();
+
+		int64_t matches = 0;
+		for (auto _ : state)
+		{
+			for (ecs::Entity e : em.EntitiesWith<Position, Velocity>())
+			{
+				benchmark::DoNotOptimize(e);
+				matches++;
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+		state.counters["matches"] = static_cast<double>(matches) / state.iterations();
+	}
+	BENCHMARK(BM_EntitiesWithSparseMatchesGrouped)->Apply(EntityCounts);
+
+	static void BM_EachSparseMatchesGrouped(benchmark::State &state)
+	{
+		const int64_t count = state.range(0);
+		ecs::EntityManager em;
+		Populate(em, count, 10);
+
+		for (int64_t i = 0; i < count; ++i)
+		{
+			em.NewEntity().Assign<Velocity>(1.f, 1.f, 1.f);
+		}
+		em.RegisterComponentGroup<Position, Velocity>();
+
+		int64_t matches = 0;
+		for (auto _ : state)
+		{
+			em.Each<Position, Velocity>([&matches](ecs::Entity, Position &position, Velocity &velocity)
+			{
+				position.x += velocity.dx;
+				matches++;
+			});
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * count);
+		state.counters["matches"] = static_cast<double>(matches) / state.iterations();
+	}
+	BENCHMARK(BM_EachSparseMatchesGrouped)->Apply(EntityCounts);
+}
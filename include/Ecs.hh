@@ -7,13 +7,25 @@
 // the entire API that a user of this library needs
 #include "ecs/Entity.hh"
 #include "ecs/EntityManager.hh"
+#include "ecs/Query.hh"
 
 // Impl files whose include order doesn't matter
 #include "ecs/EntityImpl.hh"
 #include "ecs/EntityManagerImpl.hh"
+#include "ecs/EventQueueImpl.hh"
+#include "ecs/EventStageImpl.hh"
 #include "ecs/CommonImpl.hh"
+#include "ecs/ChunkedArrayImpl.hh"
+#include "ecs/CommandBufferImpl.hh"
+#include "ecs/ComponentContainersImpl.hh"
 #include "ecs/ComponentManagerImpl.hh"
+#include "ecs/ComponentMaskImpl.hh"
 #include "ecs/ComponentStorageImpl.hh"
 #include "ecs/HandleImpl.hh"
+#include "ecs/MaskFilterImpl.hh"
+#include "ecs/QueryImpl.hh"
+#include "ecs/SignalImpl.hh"
+#include "ecs/SoaArrayImpl.hh"
 #include "ecs/SubscriptionImpl.hh"
+#include "ecs/WorkerPoolImpl.hh"
 
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ecs/Common.hh"
+
+namespace ecs
+{
+	/**
+	 * Filter for Each() and ParallelEach() (of EntityManager or Query) that only visits
+	 * entities whose CompType component was added or accessed mutably (through a Handle or
+	 * as a non-const reference given to an Each() callback) at a change tick later than
+	 * @since. CompType's StorageTraits must set trackChanges.
+	 */
+	template <typename CompType>
+	struct Changed
+	{
+		explicit Changed(uint64 since) : since(since) {}
+		uint64 since;
+	};
+
+	/**
+	 * Filter for Each() and ParallelEach() (of EntityManager or Query) that only visits
+	 * entities whose CompType component was added at a change tick later than @since.
+	 * CompType's StorageTraits must set trackChanges.
+	 */
+	template <typename CompType>
+	struct Added
+	{
+		explicit Added(uint64 since) : since(since) {}
+		uint64 since;
+	};
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <type_traits>
+
+#include "ecs/Common.hh"
+
+namespace ecs
+{
+	// largest power of 2 that is <= n (n must be > 0)
+	constexpr size_t FloorPowerOf2(size_t n, size_t p = 1)
+	{
+		return p * 2 > n ? p : FloorPowerOf2(n, p * 2);
+	}
+
+	/**
+	 * A growable array that allocates its elements in fixed-size chunks of roughly
+	 * ChunkBytes bytes.  Unlike a vector, growing never moves the existing elements
+	 * so their addresses stay valid until they are removed with pop_back() or clear().
+	 *
+	 * Only the subset of the vector interface that ComponentPool needs is provided.
+	 */
+	template <typename T, size_t ChunkBytes>
+	class ChunkedArray : public NonCopyable
+	{
+	public:
+		ChunkedArray();
+		~ChunkedArray();
+
+		template <typename ...Args>
+		void emplace_back(Args&&... args);
+		void pop_back();
+
+		T &operator[](size_t i);
+		const T &operator[](size_t i) const;
+		// same as operator[] but throws std::out_of_range if i >= size()
+		T &at(size_t i);
+
+		size_t size() const;
+		bool empty() const;
+
+		// allocate enough chunks to hold @capacity elements without allocating again
+		void reserve(size_t capacity);
+
+		// destroy every element and free every chunk
+		void clear();
+
+	private:
+		// elements per chunk, the largest power of 2 that fits in ChunkBytes
+		static constexpr size_t CHUNK_SIZE = FloorPowerOf2(
+			ChunkBytes / sizeof(T) > 0 ? ChunkBytes / sizeof(T) : 1);
+
+		typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+		vector<unique_ptr<Slot[]> > chunks;
+		size_t count;
+
+		T *slot(size_t i) const;
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <new>
+
+#include "ecs/ChunkedArray.hh"
+
+namespace ecs
+{
+	template <typename T, size_t ChunkBytes>
+	constexpr size_t ChunkedArray<T, ChunkBytes>::CHUNK_SIZE;
+
+	template <typename T, size_t ChunkBytes>
+	ChunkedArray<T, ChunkBytes>::ChunkedArray() : count(0)
+	{
+	}
+
+	template <typename T, size_t ChunkBytes>
+	ChunkedArray<T, ChunkBytes>::~ChunkedArray()
+	{
+		clear();
+	}
+
+	template <typename T, size_t ChunkBytes>
+	template <typename ...Args>
+	void ChunkedArray<T, ChunkBytes>::emplace_back(Args&&... args)
+	{
+		if (count == chunks.size() * CHUNK_SIZE)
+		{
+			chunks.emplace_back(new Slot[CHUNK_SIZE]);
+		}
+
+		new (slot(count)) T(std::forward<Args>(args)...);
+		count++;
+	}
+
+	template <typename T, size_t ChunkBytes>
+	void ChunkedArray<T, ChunkBytes>::pop_back()
+	{
+		Assert(count > 0, "cannot pop_back an empty ChunkedArray");
+		count--;
+		slot(count)->~T();
+	}
+
+	template <typename T, size_t ChunkBytes>
+	T &ChunkedArray<T, ChunkBytes>::operator[](size_t i)
+	{
+		return *slot(i);
+	}
+
+	template <typename T, size_t ChunkBytes>
+	const T &ChunkedArray<T, ChunkBytes>::operator[](size_t i) const
+	{
+		return *slot(i);
+	}
+
+	template <typename T, size_t ChunkBytes>
+	T &ChunkedArray<T, ChunkBytes>::at(size_t i)
+	{
+		if (i >= count)
+		{
+			throw std::out_of_range("ChunkedArray index out of range");
+		}
+		return *slot(i);
+	}
+
+	template <typename T, size_t ChunkBytes>
+	size_t ChunkedArray<T, ChunkBytes>::size() const
+	{
+		return count;
+	}
+
+	template <typename T, size_t ChunkBytes>
+	bool ChunkedArray<T, ChunkBytes>::empty() const
+	{
+		return count == 0;
+	}
+
+	template <typename T, size_t ChunkBytes>
+	void ChunkedArray<T, ChunkBytes>::reserve(size_t capacity)
+	{
+		while (chunks.size() * CHUNK_SIZE < capacity)
+		{
+			chunks.emplace_back(new Slot[CHUNK_SIZE]);
+		}
+	}
+
+	template <typename T, size_t ChunkBytes>
+	void ChunkedArray<T, ChunkBytes>::clear()
+	{
+		while (count > 0)
+		{
+			pop_back();
+		}
+		chunks.clear();
+	}
+
+	template <typename T, size_t ChunkBytes>
+	T *ChunkedArray<T, ChunkBytes>::slot(size_t i) const
+	{
+		return reinterpret_cast<T *>(&chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]);
+	}
+}
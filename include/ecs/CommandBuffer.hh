@@ -0,0 +1,124 @@
+#pragma once
+
+#include <mutex>
+
+#include "ecs/Common.hh"
+#include "ecs/TypeIds.hh"
+#include "ecs/Entity.hh"
+
+namespace ecs
+{
+	class EntityManager;
+
+	/**
+	 * Records structural changes (creating and destroying entities and assigning
+	 * and removing components) so that they can be applied later all at once with
+	 * EntityManager::Flush().
+	 *
+	 * This allows systems to make changes while iterating over entities, including
+	 * from ParallelEach(), without affecting what is being iterated over.
+	 * Recording commands is thread-safe.
+	 */
+	class CommandBuffer : public NonCopyable
+	{
+		friend class EntityManager;
+	public:
+		/**
+		 * Record the creation of a new entity.
+		 *
+		 * Returns a placeholder id which can be given to this buffer's other methods
+		 * to operate on the entity before it exists.  The placeholder is replaced with
+		 * the real entity when the buffer is flushed; it must not be used anywhere else.
+		 */
+		Entity::Id NewEntity();
+
+		/**
+		 * Record the assignment of a component of type "CompType" to the entity.
+		 * The component is constructed now from the forwarded arguments and moved
+		 * to the entity when the buffer is flushed, unless the entity was destroyed
+		 * by then.
+		 */
+		template <typename CompType, typename ...T>
+		void Assign(Entity::Id e, T&&... args);
+
+		/**
+		 * Record the removal of the component of type "CompType" from the entity.
+		 * Nothing is removed if the entity was destroyed by the time the buffer is flushed.
+		 */
+		template <typename CompType>
+		void Remove(Entity::Id e);
+
+		/**
+		 * Record the destruction of the entity.  Unlike EntityManager::Destroy()
+		 * it is not an error if the entity was already destroyed by the time the
+		 * buffer is flushed so several systems may destroy the same entity.
+		 */
+		void Destroy(Entity::Id e);
+
+		/**
+		 * True if no commands have been recorded since the buffer was last flushed or cleared.
+		 */
+		bool Empty() const;
+
+		/**
+		 * Discard all recorded commands.
+		 */
+		void Clear();
+
+	private:
+		/**
+		 * The component commands for one component type
+		 */
+		class BaseCommandList
+		{
+		public:
+			virtual ~BaseCommandList() {}
+
+			// apply the commands to @em in the order they were recorded
+			virtual void Apply(EntityManager &em, const vector<Entity::Id> &newEntities) = 0;
+			virtual void Clear() = 0;
+		};
+
+		template <typename CompType>
+		class CommandList : public BaseCommandList
+		{
+		public:
+			void Apply(EntityManager &em, const vector<Entity::Id> &newEntities) override;
+			void Clear() override;
+
+			struct Command
+			{
+				Entity::Id e;
+				bool assign; // otherwise remove
+			};
+			vector<Command> commands;
+
+			// components to assign, in the same order as the assign commands
+			vector<CompType> components;
+		};
+
+		mutable std::mutex mutex;
+
+		size_t commandCount = 0;
+		size_t newEntityCount = 0;
+		vector<Entity::Id> destroyedEntities;
+
+		// ComponentTypeIds::Of<T>() -> the command list for component type T
+		vector<unique_ptr<BaseCommandList>> commandLists;
+
+		// commandLists in the order that their types were first used
+		// so that flushing always happens in the same order
+		vector<BaseCommandList *> commandListOrder;
+
+		template <typename CompType>
+		CommandList<CompType> &getCommandList();
+
+		void clear();
+
+		/**
+		 * If @e is a placeholder from NewEntity() then returns the entity it was
+		 * replaced with, otherwise returns @e.
+		 */
+		static Entity::Id resolve(Entity::Id e, const vector<Entity::Id> &newEntities);
+	};
+}
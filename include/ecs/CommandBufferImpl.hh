@@ -0,0 +1,139 @@
+#pragma once
+
+#include <sstream>
+
+#include "ecs/CommandBuffer.hh"
+#include "ecs/EntityManager.hh"
+
+// CommandBuffer
+namespace ecs
+{
+	inline Entity::Id CommandBuffer::NewEntity()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		commandCount++;
+		return Entity::Id(newEntityCount++, Entity::Id::PLACEHOLDER_GENERATION);
+	}
+
+	template <typename CompType, typename ...T>
+	void CommandBuffer::Assign(Entity::Id e, T&&... args)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		CommandList<CompType> &list = getCommandList<CompType>();
+		list.components.emplace_back(std::forward<T>(args)...);
+		list.commands.push_back({e, true});
+		commandCount++;
+	}
+
+	template <typename CompType>
+	void CommandBuffer::Remove(Entity::Id e)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		getCommandList<CompType>().commands.push_back({e, false});
+		commandCount++;
+	}
+
+	inline void CommandBuffer::Destroy(Entity::Id e)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		destroyedEntities.push_back(e);
+		commandCount++;
+	}
+
+	inline bool CommandBuffer::Empty() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return commandCount == 0;
+	}
+
+	inline void CommandBuffer::Clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		clear();
+	}
+
+	template <typename CompType>
+	CommandBuffer::CommandList<CompType> &CommandBuffer::getCommandList()
+	{
+		size_t typeId = ComponentTypeIds::Of<CompType>();
+		if (commandLists.size() <= typeId)
+		{
+			commandLists.resize(typeId + 1);
+		}
+
+		unique_ptr<BaseCommandList> &list = commandLists[typeId];
+		if (!list)
+		{
+			list.reset(new CommandList<CompType>());
+			commandListOrder.push_back(list.get());
+		}
+		return *static_cast<CommandList<CompType> *>(list.get());
+	}
+
+	inline void CommandBuffer::clear()
+	{
+		// keep the lists around so their memory can be reused
+		for (auto list : commandListOrder)
+		{
+			list->Clear();
+		}
+		destroyedEntities.clear();
+		newEntityCount = 0;
+		commandCount = 0;
+	}
+
+	inline Entity::Id CommandBuffer::resolve(Entity::Id e, const vector<Entity::Id> &newEntities)
+	{
+		if (e.Generation() != Entity::Id::PLACEHOLDER_GENERATION)
+		{
+			return e;
+		}
+
+		if (e.Index() >= newEntities.size())
+		{
+			std::stringstream ss;
+			ss << "placeholder entity " << e << " was not created by this CommandBuffer";
+			throw invalid_argument(ss.str());
+		}
+		return newEntities[e.Index()];
+	}
+}
+
+// CommandBuffer::CommandList
+namespace ecs
+{
+	template <typename CompType>
+	void CommandBuffer::CommandList<CompType>::Apply(EntityManager &em,
+		const vector<Entity::Id> &newEntities)
+	{
+		size_t compIndex = 0;
+		for (auto &command : commands)
+		{
+			Entity::Id e = resolve(command.e, newEntities);
+
+			// the entity was destroyed after the command was recorded, its index
+			// may even belong to another entity by now
+			if (!em.Valid(e))
+			{
+				compIndex += command.assign ? 1 : 0;
+				continue;
+			}
+
+			if (command.assign)
+			{
+				em.Emplace<CompType>(e, std::move(components[compIndex++]));
+			}
+			else
+			{
+				em.Remove<CompType>(e);
+			}
+		}
+	}
+
+	template <typename CompType>
+	void CommandBuffer::CommandList<CompType>::Clear()
+	{
+		commands.clear();
+		components.clear();
+	}
+}
@@ -12,6 +12,10 @@ using std::vector;
 #include <string>
 using std::string;
 
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include <stdexcept>
 using std::runtime_error;
 using std::invalid_argument;
@@ -53,6 +57,77 @@ namespace ecs
 		NonCopyable() = default;
 	};
 
+	/**
+	 * Compile time sequence of indexes, used to expand a parameter pack
+	 * alongside the index of each of its elements (like C++14's std::index_sequence)
+	 */
+	template <size_t ...Indexes>
+	struct IndexSequence {};
+
+	template <size_t N, size_t ...Indexes>
+	struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, Indexes...> {};
+
+	template <size_t ...Indexes>
+	struct MakeIndexSequence<0, Indexes...>
+	{
+		typedef IndexSequence<Indexes...> type;
+	};
+
+	/**
+	 * WritesArg<Func, I>::value is false if parameter @I of the callable Func is
+	 * known to not modify what it is given (taken by value or by const reference).
+	 * It is true for non-const references and when the parameters can't be found,
+	 * ex. for a functor with an overloaded or template operator().
+	 */
+	template <typename Func, size_t I, typename = void>
+	struct WritesArg : std::true_type {};
+
+	template <typename Func, size_t I>
+	struct WritesArg<Func, I, decltype((void)&Func::operator())>
+		: WritesArg<decltype(&Func::operator()), I> {};
+
+	template <typename Ret, typename ...Args, size_t I>
+	struct WritesArg<Ret (*)(Args...), I, void>
+		: std::integral_constant<bool, std::is_lvalue_reference<typename std::tuple_element<I, std::tuple<Args...>>::type>::value
+			&& !std::is_const<typename std::remove_reference<typename std::tuple_element<I, std::tuple<Args...>>::type>::type>::value> {};
+
+	template <typename Class, typename Ret, typename ...Args, size_t I>
+	struct WritesArg<Ret (Class::*)(Args...), I, void> : WritesArg<Ret (*)(Args...), I> {};
+
+	template <typename Class, typename Ret, typename ...Args, size_t I>
+	struct WritesArg<Ret (Class::*)(Args...) const, I, void> : WritesArg<Ret (*)(Args...), I> {};
+
+	/**
+	 * A view of a contiguous array of T that it doesn't own (like C++20's std::span).
+	 * It can be created from a pointer and size or from any container with
+	 * data() and size() methods such as a vector.
+	 */
+	template <typename T>
+	class Span
+	{
+	public:
+		Span() : data(nullptr), size(0) {}
+		Span(T *data, size_t size) : data(data), size(size) {}
+
+		template <typename Container, typename = decltype(std::declval<Container &>().data())>
+		Span(Container &container) : data(container.data()), size(container.size()) {}
+
+		template <typename Container, typename = decltype(std::declval<const Container &>().data())>
+		Span(const Container &container) : data(container.data()), size(container.size()) {}
+
+		T *begin() const { return data; }
+		T *end() const { return data + size; }
+		T &operator[](size_t i) const { return data[i]; }
+
+		T *Data() const { return data; }
+		size_t Size() const { return size; }
+		bool Empty() const { return size == 0; }
+
+	private:
+		T *data;
+		size_t size;
+	};
+
 	/**
 	 * Functor that can be instantiated as a hash function for an enum class.
 	 * Useful for when you want to use an enum class as an unordered_map key
@@ -30,6 +30,12 @@ namespace ecs
 
 	inline void Assert(bool condition)
 	{
-		return Assert(condition, "assertion failed");
+		// only build the message on failure, this is called from hot paths such as Entity::Id's constructor
+#ifndef NDEBUG
+		if (!condition)
+		{
+			Assert(condition, "assertion failed");
+		}
+#endif
 	}
 }
\ No newline at end of file
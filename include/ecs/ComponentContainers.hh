@@ -0,0 +1,74 @@
+#pragma once
+
+#include <type_traits>
+
+#include "ecs/Common.hh"
+
+namespace ecs
+{
+	/**
+	 * Component container for empty "tag" types.  It only counts its elements,
+	 * every index refers to the same shared instance since an empty type has no
+	 * state to tell them apart.
+	 *
+	 * Provides the same subset of the vector interface as ChunkedArray.
+	 */
+	template <typename T>
+	class TagArray : public NonCopyable
+	{
+	public:
+		static_assert(std::is_empty<T>::value, "only empty types can be stored in a TagArray");
+
+		TagArray();
+
+		template <typename ...Args>
+		void emplace_back(Args&&... args);
+		void pop_back();
+
+		T &operator[](size_t i);
+		const T &operator[](size_t i) const;
+		T &at(size_t i);
+
+		size_t size() const;
+		bool empty() const;
+		void reserve(size_t capacity);
+		void clear();
+
+	private:
+		T instance;
+		size_t count;
+	};
+
+	/**
+	 * Component container that holds at most one element, stored inline so that
+	 * it never allocates.  Adding a second element throws a runtime_error.
+	 *
+	 * Provides the same subset of the vector interface as ChunkedArray.
+	 */
+	template <typename T>
+	class SingletonArray : public NonCopyable
+	{
+	public:
+		SingletonArray();
+		~SingletonArray();
+
+		template <typename ...Args>
+		void emplace_back(Args&&... args);
+		void pop_back();
+
+		T &operator[](size_t i);
+		const T &operator[](size_t i) const;
+		T &at(size_t i);
+
+		size_t size() const;
+		bool empty() const;
+		void reserve(size_t capacity);
+		void clear();
+
+	private:
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+		bool full;
+
+		T *get() const;
+	};
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <new>
+
+#include "ecs/ComponentContainers.hh"
+
+// TagArray
+namespace ecs
+{
+	template <typename T>
+	TagArray<T>::TagArray() : count(0)
+	{
+	}
+
+	template <typename T>
+	template <typename ...Args>
+	void TagArray<T>::emplace_back(Args&&... args)
+	{
+		// still run the constructor in case it has side effects
+		(void)T(std::forward<Args>(args)...);
+		count++;
+	}
+
+	template <typename T>
+	void TagArray<T>::pop_back()
+	{
+		Assert(count > 0, "cannot pop_back an empty TagArray");
+		count--;
+	}
+
+	template <typename T>
+	T &TagArray<T>::operator[](size_t)
+	{
+		return instance;
+	}
+
+	template <typename T>
+	const T &TagArray<T>::operator[](size_t) const
+	{
+		return instance;
+	}
+
+	template <typename T>
+	T &TagArray<T>::at(size_t i)
+	{
+		if (i >= count)
+		{
+			throw std::out_of_range("TagArray index out of range");
+		}
+		return instance;
+	}
+
+	template <typename T>
+	size_t TagArray<T>::size() const
+	{
+		return count;
+	}
+
+	template <typename T>
+	bool TagArray<T>::empty() const
+	{
+		return count == 0;
+	}
+
+	template <typename T>
+	void TagArray<T>::reserve(size_t)
+	{
+	}
+
+	template <typename T>
+	void TagArray<T>::clear()
+	{
+		count = 0;
+	}
+}
+
+// SingletonArray
+namespace ecs
+{
+	template <typename T>
+	SingletonArray<T>::SingletonArray() : full(false)
+	{
+	}
+
+	template <typename T>
+	SingletonArray<T>::~SingletonArray()
+	{
+		clear();
+	}
+
+	template <typename T>
+	template <typename ...Args>
+	void SingletonArray<T>::emplace_back(Args&&... args)
+	{
+		if (full)
+		{
+			throw runtime_error("a singleton component can only be assigned to one entity at a time");
+		}
+
+		new (get()) T(std::forward<Args>(args)...);
+		full = true;
+	}
+
+	template <typename T>
+	void SingletonArray<T>::pop_back()
+	{
+		Assert(full, "cannot pop_back an empty SingletonArray");
+		get()->~T();
+		full = false;
+	}
+
+	template <typename T>
+	T &SingletonArray<T>::operator[](size_t)
+	{
+		return *get();
+	}
+
+	template <typename T>
+	const T &SingletonArray<T>::operator[](size_t) const
+	{
+		return *get();
+	}
+
+	template <typename T>
+	T &SingletonArray<T>::at(size_t i)
+	{
+		if (i >= size())
+		{
+			throw std::out_of_range("SingletonArray index out of range");
+		}
+		return *get();
+	}
+
+	template <typename T>
+	size_t SingletonArray<T>::size() const
+	{
+		return full ? 1 : 0;
+	}
+
+	template <typename T>
+	bool SingletonArray<T>::empty() const
+	{
+		return !full;
+	}
+
+	template <typename T>
+	void SingletonArray<T>::reserve(size_t)
+	{
+	}
+
+	template <typename T>
+	void SingletonArray<T>::clear()
+	{
+		if (full)
+		{
+			pop_back();
+		}
+	}
+
+	template <typename T>
+	T *SingletonArray<T>::get() const
+	{
+		return reinterpret_cast<T *>(const_cast<typename std::aligned_storage<sizeof(T), alignof(T)>::type *>(&storage));
+	}
+}
@@ -1,25 +1,29 @@
 #pragma once
 
 #include <typeindex>
-#include <bitset>
 #include <sstream>
 
 #include "ecs/Common.hh"
+#include "ecs/ComponentMask.hh"
 #include "ecs/Entity.hh"
 #include "ecs/ComponentStorage.hh"
+#include "ecs/TypeIds.hh"
 #include "ecs/UnrecognizedComponentType.hh"
 #include "ecs/Handle.hh"
 
-#define MAX_COMPONENT_TYPES 64
-
 namespace ecs
 {
+	template <typename ...CompTypes>
+	class Query;
+
 	class ComponentManager
 	{
 		// TODO-cs: should probably just merge these two classes
 		friend class EntityManager;
+		template <typename ...CompTypes>
+		friend class Query;
 	public:
-		typedef std::bitset<MAX_COMPONENT_TYPES> ComponentMask;
+		typedef ecs::ComponentMask ComponentMask;
 
 		~ComponentManager()
 		{
@@ -29,6 +33,18 @@ namespace ecs
 		template <typename CompType, typename ...T>
 		Handle<CompType> Assign(Entity::Id e, T... args);
 
+		// same as Assign() but CompType is constructed in place from the forwarded arguments
+		template <typename CompType, typename ...T>
+		Handle<CompType> Emplace(Entity::Id e, T&&... args);
+
+		/**
+		 * Assign a copy of @component to each of the @count entities in @entities.
+		 * Same as calling Assign() for each entity but the pool is only looked up
+		 * and grown once.
+		 */
+		template <typename CompType>
+		void AssignMany(const Entity::Id *entities, size_t count, const CompType &component);
+
 		template <typename CompType>
 		void Remove(Entity::Id e);
 
@@ -63,24 +79,106 @@ namespace ecs
 		template<typename CompType>
 		void RegisterComponentType();
 
+		/**
+		 * Keep the components of entities that have all of the given component types
+		 * packed together at the front of each of their pools, in the same order in
+		 * every pool.  See EntityManager::RegisterComponentGroup.
+		 *
+		 * This will throw an std::runtime_error if any of the types already belong to a group.
+		 */
+		template <typename ...CompTypes>
+		void RegisterGroup();
+
 	private:
-		template <typename TypeId>
-		ComponentMask &setMask(ComponentManager::ComponentMask &mask, const TypeId &stdTypeId);
+		static const uint32 NO_COMP_INDEX = static_cast<uint32>(-1);
+
+		/**
+		 * Returns the component index of CompType or NO_COMP_INDEX if it isn't registered.
+		 */
+		template <typename CompType>
+		uint32 compIndexOf() const;
+
+		/**
+		 * Returns the pool storing components of type CompType.
+		 * Throws UnrecognizedComponentType if the type isn't registered.
+		 */
+		template <typename CompType>
+		ComponentPool<CompType> *getPool();
+
+		/**
+		 * A set of component pools whose first "size" components all belong to
+		 * the entities that have every component in the set and are stored in
+		 * the same order in each pool.  Essentially a table with one column
+		 * per component type.
+		 *
+		 * When the group is not "packed", its pools have been modified while one of
+		 * them was iterate locked so the ordering couldn't be maintained. It gets
+		 * repacked the next time that it is used while none of its pools are locked.
+		 */
+		struct Group
+		{
+			ComponentMask mask;
+			vector<BaseComponentPool *> pools;
+			size_t size = 0;
+			bool packed = false;
+		};
+
+		/**
+		 * Returns the group whose components all belong to a query for @mask or
+		 * nullptr if there is no such group that is currently packed and can be used.
+		 */
+		Group *groupFor(const ComponentMask &mask);
+
+		// reorder the pools of the group so that it is packed again
+		void pack(Group &group);
+
+		bool groupLocked(const Group &group) const;
 
-		template <typename TypeId, typename ...OtherTypeIds>
-		ComponentMask &setMask(ComponentManager::ComponentMask &mask, const TypeId &stdTypeId, const OtherTypeIds &... stdTypeIds);
+		// true if any component pool is iterate locked
+		bool anyPoolLocked() const;
+
+		// remove every component from every entity at once.
+		// Must not be called while any pool is iterate locked.
+		void clear();
+
+		// called after an entity gets a component that is part of a group
+		void onGroupComponentAdded(Entity::Id e, uint32 compIndex);
+
+		// called before an entity loses a component that is part of a group
+		void onGroupComponentRemoved(Entity::Id e, uint32 compIndex);
+
+		template <typename CompType>
+		void setMask(ComponentMask &mask);
 
 		// vector of ComponentPool<T>* where each pool is the underlying storage
 		// for a different type of component.
 		vector<BaseComponentPool *> componentPools;
 
-		// map the typeid(T) of a component type, T, to the "index" of that
-		// component type. Any time each component type stores info in a vector, this index
-		// will identify which component type it corresponds to
+		// map ComponentTypeIds::Of<T>() of a component type, T, to the "index" of that
+		// component type or NO_COMP_INDEX if T isn't registered. Any time each component
+		// type stores info in a vector, this index will identify which component type it
+		// corresponds to
+		vector<uint32> typeIdToCompIndex;
+
+		// same as typeIdToCompIndex but keyed by typeid(T). This is only used when
+		// registering component types and for diagnostics, never for per-call lookups.
 		GLOMERATE_MAP_TYPE<std::type_index, uint32> compTypeToCompIndex;
 
-		// An entity's index gives a bitmask for the components that it has. If bitset[i] is set
+		// An entity's index gives a bitmask for the components that it has. If mask[i] is set
 		// then it means this entity has the component with component index i
 		vector<ComponentMask> entCompMasks;
+
+		// incremented whenever any entity's mask changes so that iteration knows when
+		// masks it already filtered may be out of date
+		uint64 maskVersion = 0;
+
+		// components added or accessed mutably are stamped with this tick if their
+		// type tracks changes, see EntityManager::AdvanceChangeTick()
+		uint64 changeTick = 1;
+
+		vector<unique_ptr<Group> > groups;
+
+		// component index -> the group that its pool belongs to, if any
+		vector<Group *> compIndexToGroup;
 	};
 }
@@ -9,83 +9,162 @@ namespace ecs
 		return componentPools.size();
 	}
 
+	template <typename CompType>
+	uint32 ComponentManager::compIndexOf() const
+	{
+		size_t typeId = ComponentTypeIds::Of<CompType>();
+		return typeId < typeIdToCompIndex.size() ? typeIdToCompIndex[typeId] : NO_COMP_INDEX;
+	}
+
 	template <typename CompType, typename ...T>
 	Handle<CompType> ComponentManager::Assign(Entity::Id e, T... args)
 	{
-		std::type_index compType = typeid(CompType);
+		return Emplace<CompType>(e, std::move(args)...);
+	}
 
-		uint32 compIndex;
+	template <typename CompType, typename ...T>
+	Handle<CompType> ComponentManager::Emplace(Entity::Id e, T&&... args)
+	{
+		uint32 compIndex = compIndexOf<CompType>();
 
-		try
-		{
-			compIndex = compTypeToCompIndex.at(compType);
-		}
 		// component never seen before, add it to the collection
-		catch (const std::out_of_range &e)
+		if (compIndex == NO_COMP_INDEX)
 		{
 			RegisterComponentType<CompType>();
-			compIndex = compTypeToCompIndex.at(compType);
+			compIndex = compIndexOf<CompType>();
 		}
 
 		Assert(entCompMasks.size() > e.Index(), "entity does not have a component mask");
 
 		auto &compMask = entCompMasks.at(e.Index());
+		auto componentPool = static_cast<ComponentPool<CompType>*>(componentPools.at(compIndex));
+
+		// the pool may refuse the component so only set the mask bit once it's added
+		if (compMask[compIndex])
+		{
+			// replace an existing component so that the entity never has 2 of them in
+			// the pool. The replacement is built first since @args may refer to it.
+			CompType replacement(std::forward<T>(args)...);
+			Remove<CompType>(e);
+			componentPool->NewComponent(e, std::move(replacement));
+		}
+		else
+		{
+			componentPool->NewComponent(e, std::forward<T>(args)...);
+		}
 		compMask.set(compIndex);
+		maskVersion++;
 
-		auto componentPool = static_cast<ComponentPool<CompType>*>(componentPools.at(compIndex));
-		componentPool->NewComponent(e, args...);
+		if (compIndexToGroup[compIndex] != nullptr)
+		{
+			onGroupComponentAdded(e, compIndex);
+		}
 		return Handle<CompType>(e, componentPool);
 	}
 
 	template <typename CompType>
-	void ComponentManager::Remove(Entity::Id e)
+	void ComponentManager::AssignMany(const Entity::Id *entities, size_t count, const CompType &component)
 	{
-		std::type_index tIndex = typeid(CompType);
-		if (compTypeToCompIndex.count(tIndex) == 0)
+		uint32 compIndex = compIndexOf<CompType>();
+		if (compIndex == NO_COMP_INDEX)
+		{
+			RegisterComponentType<CompType>();
+			compIndex = compIndexOf<CompType>();
+		}
+
+		auto componentPool = static_cast<ComponentPool<CompType>*>(componentPools[compIndex]);
+		componentPool->Reserve(count);
+
+		for (size_t i = 0; i < count; ++i)
 		{
-			throw UnrecognizedComponentType(tIndex);
+			Entity::Id e = entities[i];
+			Assert(entCompMasks.size() > e.Index(), "entity does not have a component mask");
+
+			auto &compMask = entCompMasks[e.Index()];
+			if (compMask[compIndex])
+			{
+				Remove<CompType>(e);
+			}
+
+			componentPool->NewComponent(e, component);
+			compMask.set(compIndex);
+			maskVersion++;
+
+			if (compIndexToGroup[compIndex] != nullptr)
+			{
+				onGroupComponentAdded(e, compIndex);
+			}
 		}
+	}
 
-		uint32 compIndex = compTypeToCompIndex.at(tIndex);
+	template <typename CompType>
+	void ComponentManager::Remove(Entity::Id e)
+	{
+		uint32 compIndex = compIndexOf<CompType>();
+		if (compIndex == NO_COMP_INDEX)
+		{
+			throw UnrecognizedComponentType(typeid(CompType));
+		}
 
 		auto &compMask = entCompMasks.at(e.Index());
 		if (compMask[compIndex] == false)
 		{
 			throw runtime_error("entity does not have a component of type "
-				+ string(tIndex.name()));
+				+ string(typeid(CompType).name()));
+		}
+
+		if (compIndexToGroup[compIndex] != nullptr)
+		{
+			onGroupComponentRemoved(e, compIndex);
 		}
 
 		static_cast<ComponentPool<CompType>*>(componentPools.at(compIndex))->Remove(e);
 		compMask.reset(compIndex);
+		maskVersion++;
 	}
 
 	template <typename CompType>
 	bool ComponentManager::Has(Entity::Id e) const
 	{
-		std::type_index compType = typeid(CompType);
-		if (compTypeToCompIndex.count(compType) == 0)
+		uint32 compIndex = compIndexOf<CompType>();
+		if (compIndex == NO_COMP_INDEX)
 		{
-			throw UnrecognizedComponentType(compType);
+			throw UnrecognizedComponentType(typeid(CompType));
 		}
 
-		auto compIndex = compTypeToCompIndex.at(compType);
 		return entCompMasks.at(e.Index())[compIndex];
 	}
 
 	template <typename CompType>
 	Handle<CompType> ComponentManager::Get(Entity::Id e)
 	{
-		if (!Has<CompType>(e))
+		uint32 compIndex = compIndexOf<CompType>();
+		if (compIndex == NO_COMP_INDEX)
+		{
+			throw UnrecognizedComponentType(typeid(CompType));
+		}
+
+		if (!entCompMasks.at(e.Index())[compIndex])
 		{
 			throw runtime_error("entity does not have a component of type "
 				+ string(typeid(CompType).name()));
 		}
 
-		auto compIndex = compTypeToCompIndex.at(typeid(CompType));
 		auto *compPool = static_cast<ComponentPool<CompType>*>(componentPools.at(compIndex));
 		return Handle<CompType>(e, compPool);
 	}
 
+	template <typename CompType>
+	ComponentPool<CompType> *ComponentManager::getPool()
+	{
+		uint32 compIndex = compIndexOf<CompType>();
+		if (compIndex == NO_COMP_INDEX)
+		{
+			throw UnrecognizedComponentType(typeid(CompType));
+		}
+		return static_cast<ComponentPool<CompType>*>(componentPools[compIndex]);
+	}
+
 	template <typename CompType>
 	void ComponentManager::RegisterComponentType()
 	{
@@ -98,9 +177,225 @@ namespace ecs
 			throw std::runtime_error(ss.str());
 		}
 
+		if (componentPools.size() >= ComponentMask::BITS)
+		{
+			std::stringstream ss;
+			ss << "cannot register component type " << string(compType.name()) << ", the limit is "
+				<< ComponentMask::BITS << " component types (see GLOMERATE_MAX_COMPONENT_TYPES)";
+			throw std::runtime_error(ss.str());
+		}
+
 		uint32 compIndex = componentPools.size();
 		compTypeToCompIndex[compType] = compIndex;
-		componentPools.push_back(new ComponentPool<CompType>());
+
+		size_t typeId = ComponentTypeIds::Of<CompType>();
+		if (typeIdToCompIndex.size() <= typeId)
+		{
+			uint32 unregistered = NO_COMP_INDEX;
+			typeIdToCompIndex.resize(typeId + 1, unregistered);
+		}
+		typeIdToCompIndex[typeId] = compIndex;
+
+		auto pool = new ComponentPool<CompType>();
+		pool->changeTick = &changeTick;
+		componentPools.push_back(pool);
+		compIndexToGroup.push_back(nullptr);
+	}
+
+	template <typename ...CompTypes>
+	void ComponentManager::RegisterGroup()
+	{
+		static_assert(sizeof...(CompTypes) >= 2, "a group needs at least 2 component types");
+
+		// register any component types that have never been seen
+		std::type_index compTypes[] = { std::type_index(typeid(CompTypes))... };
+		int unused[] = { (compIndexOf<CompTypes>() == NO_COMP_INDEX
+			? (RegisterComponentType<CompTypes>(), 0) : 0)... };
+		(void)unused;
+
+		unique_ptr<Group> group(new Group());
+		group->mask = CreateMask<CompTypes...>();
+
+		for (uint32 i = 0; i < componentPools.size(); ++i)
+		{
+			if (!group->mask.test(i))
+			{
+				continue;
+			}
+
+			if (compIndexToGroup[i] != nullptr)
+			{
+				std::stringstream ss;
+				ss << "component types ";
+				for (auto &compType : compTypes)
+				{
+					ss << string(compType.name()) << " ";
+				}
+				ss << "cannot be grouped because one of them is already in a group";
+				throw std::runtime_error(ss.str());
+			}
+
+			group->pools.push_back(componentPools[i]);
+		}
+
+		for (uint32 i = 0; i < componentPools.size(); ++i)
+		{
+			if (group->mask.test(i))
+			{
+				compIndexToGroup[i] = group.get();
+			}
+		}
+
+		if (!groupLocked(*group))
+		{
+			pack(*group);
+		}
+		groups.push_back(std::move(group));
+	}
+
+	inline ComponentManager::Group *ComponentManager::groupFor(const ComponentMask &mask)
+	{
+		Group *best = nullptr;
+		for (auto &group : groups)
+		{
+			if (!mask.Contains(group->mask))
+			{
+				continue;
+			}
+
+			if (!group->packed)
+			{
+				if (groupLocked(*group))
+				{
+					continue;
+				}
+				pack(*group);
+			}
+
+			if (best == nullptr || group->size < best->size)
+			{
+				best = group.get();
+			}
+		}
+		return best;
+	}
+
+	inline bool ComponentManager::groupLocked(const Group &group) const
+	{
+		for (auto pool : group.pools)
+		{
+			if (pool->IterateLocked())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline bool ComponentManager::anyPoolLocked() const
+	{
+		for (auto pool : componentPools)
+		{
+			if (pool->IterateLocked())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline void ComponentManager::clear()
+	{
+		for (auto pool : componentPools)
+		{
+			pool->Clear();
+		}
+
+		for (auto &group : groups)
+		{
+			group->size = 0;
+			group->packed = true;
+		}
+
+		std::fill(entCompMasks.begin(), entCompMasks.end(), ComponentMask());
+		maskVersion++;
+	}
+
+	inline void ComponentManager::pack(Group &group)
+	{
+		Assert(!groupLocked(group), "cannot pack a group while one of its pools is iterate locked");
+
+		BaseComponentPool *smallest = group.pools.front();
+		for (auto pool : group.pools)
+		{
+			if (pool->Size() < smallest->Size())
+			{
+				smallest = pool;
+			}
+		}
+
+		// partition every pool so that members of the group come first. Components
+		// before "i" in the smallest pool have already been checked so swapping one
+		// of them into "i" doesn't skip anything.
+		group.size = 0;
+		for (size_t i = 0; i < smallest->Size(); ++i)
+		{
+			Entity::Id e = smallest->entityAt(i);
+			if (!entCompMasks[e.Index()].Contains(group.mask))
+			{
+				continue;
+			}
+
+			for (auto pool : group.pools)
+			{
+				pool->swapComponents(pool->indexOf(e), group.size);
+			}
+			group.size++;
+		}
+
+		group.packed = true;
+	}
+
+	inline void ComponentManager::onGroupComponentAdded(Entity::Id e, uint32 compIndex)
+	{
+		Group &group = *compIndexToGroup[compIndex];
+		if (!group.packed || !entCompMasks[e.Index()].Contains(group.mask))
+		{
+			return;
+		}
+
+		if (groupLocked(group))
+		{
+			group.packed = false;
+			return;
+		}
+
+		for (auto pool : group.pools)
+		{
+			pool->swapComponents(pool->indexOf(e), group.size);
+		}
+		group.size++;
+	}
+
+	inline void ComponentManager::onGroupComponentRemoved(Entity::Id e, uint32 compIndex)
+	{
+		Group &group = *compIndexToGroup[compIndex];
+		if (!group.packed || !entCompMasks[e.Index()].Contains(group.mask))
+		{
+			return;
+		}
+
+		if (groupLocked(group))
+		{
+			group.packed = false;
+			return;
+		}
+
+		group.size--;
+		for (auto pool : group.pools)
+		{
+			pool->swapComponents(pool->indexOf(e), group.size);
+		}
 	}
 
 	template <typename ...CompTypes>
@@ -117,27 +412,20 @@ namespace ecs
 	template <typename ...CompTypes>
 	ComponentManager::ComponentMask &ComponentManager::SetMask(ComponentMask &mask)
 	{
-		return setMask(mask, std::type_index(typeid(CompTypes))...);
+		int unused[] = { 0, (setMask<CompTypes>(mask), 0)... };
+		(void)unused;
+		return mask;
 	}
 
-	template <typename TypeId>
-	ComponentManager::ComponentMask &ComponentManager::setMask(ComponentMask &mask, const TypeId &stdTypeId)
+	template <typename CompType>
+	void ComponentManager::setMask(ComponentMask &mask)
 	{
-		if (compTypeToCompIndex.count(stdTypeId) == 0)
+		uint32 compIndex = compIndexOf<CompType>();
+		if (compIndex == NO_COMP_INDEX)
 		{
-			throw invalid_argument(string(stdTypeId.name()) + " is an invalid component type, it is unknown to the system.");
+			throw invalid_argument(string(typeid(CompType).name()) + " is an invalid component type, it is unknown to the system.");
 		}
-		auto compIndex = compTypeToCompIndex.at(stdTypeId);
 		mask.set(compIndex);
-		return mask;
-	}
-
-	template <typename TypeId, typename ...OtherTypeIds>
-	ComponentManager::ComponentMask &ComponentManager::setMask(ComponentManager::ComponentMask &mask,
-			const TypeId &stdTypeId, const OtherTypeIds &... stdTypeIds)
-	{
-		setMask(mask, stdTypeId);
-		return setMask(mask, stdTypeIds...);
 	}
 
 	inline void ComponentManager::RemoveAll(Entity::Id e)
@@ -149,10 +437,15 @@ namespace ecs
 		{
 			if (compMask[i])
 			{
+				if (compIndexToGroup[i] != nullptr)
+				{
+					onGroupComponentRemoved(e, i);
+				}
 				componentPools.at(i)->Remove(e);
 				compMask.reset(i);
 			}
 		}
+		maskVersion++;
 
 		Assert(compMask == ComponentMask(),
 			"component mask not blank after removing all components");
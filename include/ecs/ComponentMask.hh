@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ostream>
+
+#include "ecs/Common.hh"
+
+// Most component types an EntityManager can have, every entity's mask has one bit per type.
+// Can be raised (ex. 128, 256, 512) at the cost of 8 more bytes per entity for every 64 types.
+#ifndef GLOMERATE_MAX_COMPONENT_TYPES
+#define GLOMERATE_MAX_COMPONENT_TYPES 64
+#endif
+
+// deprecated name of GLOMERATE_MAX_COMPONENT_TYPES
+#define MAX_COMPONENT_TYPES GLOMERATE_MAX_COMPONENT_TYPES
+
+namespace ecs
+{
+	/**
+	 * Fixed-size set of component indexes stored as an array of 64 bit words.
+	 * Provides the parts of the std::bitset interface that masks used to be
+	 * used with, plus word access for filtering masks in bulk.
+	 */
+	class ComponentMask
+	{
+	public:
+		static const size_t BITS = GLOMERATE_MAX_COMPONENT_TYPES;
+		static const size_t WORD_BITS = 64;
+		static const size_t WORDS = (BITS + WORD_BITS - 1) / WORD_BITS;
+
+		ComponentMask();
+
+		// throws std::out_of_range if @i >= size()
+		bool test(size_t i) const;
+		bool operator[](size_t i) const;
+
+		ComponentMask &set(size_t i);
+		ComponentMask &reset(size_t i);
+		ComponentMask &reset();
+
+		bool any() const;
+		bool none() const;
+		size_t count() const;
+		size_t size() const;
+
+		ComponentMask &operator&=(const ComponentMask &other);
+		ComponentMask &operator|=(const ComponentMask &other);
+		ComponentMask operator&(const ComponentMask &other) const;
+		ComponentMask operator|(const ComponentMask &other) const;
+		bool operator==(const ComponentMask &other) const;
+		bool operator!=(const ComponentMask &other) const;
+
+		// true if every bit set in @other is also set in this mask
+		bool Contains(const ComponentMask &other) const;
+
+		// bits [64 * @w, 64 * @w + 63] of the mask
+		uint64 Word(size_t w) const;
+
+	private:
+		uint64 words[WORDS];
+	};
+
+	// prints the bits from highest to lowest like std::bitset
+	std::ostream &operator<<(std::ostream &os, const ComponentMask &mask);
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "ecs/ComponentMask.hh"
+
+namespace ecs
+{
+	inline ComponentMask::ComponentMask()
+	{
+		reset();
+	}
+
+	inline bool ComponentMask::test(size_t i) const
+	{
+		if (i >= BITS)
+		{
+			throw std::out_of_range("component mask index out of range");
+		}
+		return (*this)[i];
+	}
+
+	inline bool ComponentMask::operator[](size_t i) const
+	{
+		return (words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+	}
+
+	inline ComponentMask &ComponentMask::set(size_t i)
+	{
+		if (i >= BITS)
+		{
+			throw std::out_of_range("component mask index out of range");
+		}
+		words[i / WORD_BITS] |= (uint64)1 << (i % WORD_BITS);
+		return *this;
+	}
+
+	inline ComponentMask &ComponentMask::reset(size_t i)
+	{
+		if (i >= BITS)
+		{
+			throw std::out_of_range("component mask index out of range");
+		}
+		words[i / WORD_BITS] &= ~((uint64)1 << (i % WORD_BITS));
+		return *this;
+	}
+
+	inline ComponentMask &ComponentMask::reset()
+	{
+		for (size_t w = 0; w < WORDS; ++w)
+		{
+			words[w] = 0;
+		}
+		return *this;
+	}
+
+	inline bool ComponentMask::any() const
+	{
+		uint64 bits = 0;
+		for (size_t w = 0; w < WORDS; ++w)
+		{
+			bits |= words[w];
+		}
+		return bits != 0;
+	}
+
+	inline bool ComponentMask::none() const
+	{
+		return !any();
+	}
+
+	inline size_t ComponentMask::count() const
+	{
+		size_t total = 0;
+		for (size_t w = 0; w < WORDS; ++w)
+		{
+			for (uint64 bits = words[w]; bits != 0; bits &= bits - 1)
+			{
+				total++;
+			}
+		}
+		return total;
+	}
+
+	inline size_t ComponentMask::size() const
+	{
+		return BITS;
+	}
+
+	inline ComponentMask &ComponentMask::operator&=(const ComponentMask &other)
+	{
+		for (size_t w = 0; w < WORDS; ++w)
+		{
+			words[w] &= other.words[w];
+		}
+		return *this;
+	}
+
+	inline ComponentMask &ComponentMask::operator|=(const ComponentMask &other)
+	{
+		for (size_t w = 0; w < WORDS; ++w)
+		{
+			words[w] |= other.words[w];
+		}
+		return *this;
+	}
+
+	inline ComponentMask ComponentMask::operator&(const ComponentMask &other) const
+	{
+		ComponentMask result(*this);
+		return result &= other;
+	}
+
+	inline ComponentMask ComponentMask::operator|(const ComponentMask &other) const
+	{
+		ComponentMask result(*this);
+		return result |= other;
+	}
+
+	inline bool ComponentMask::operator==(const ComponentMask &other) const
+	{
+		uint64 diff = 0;
+		for (size_t w = 0; w < WORDS; ++w)
+		{
+			diff |= words[w] ^ other.words[w];
+		}
+		return diff == 0;
+	}
+
+	inline bool ComponentMask::operator!=(const ComponentMask &other) const
+	{
+		return !(*this == other);
+	}
+
+	inline bool ComponentMask::Contains(const ComponentMask &other) const
+	{
+		// no early exit so that the compiler can vectorize wide masks
+		uint64 missing = 0;
+		for (size_t w = 0; w < WORDS; ++w)
+		{
+			missing |= other.words[w] & ~words[w];
+		}
+		return missing == 0;
+	}
+
+	inline uint64 ComponentMask::Word(size_t w) const
+	{
+		return words[w];
+	}
+
+	inline std::ostream &operator<<(std::ostream &os, const ComponentMask &mask)
+	{
+		for (size_t i = mask.size(); i > 0; --i)
+		{
+			os << (mask[i - 1] ? '1' : '0');
+		}
+		return os;
+	}
+}
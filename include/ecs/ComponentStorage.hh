@@ -1,14 +1,17 @@
 #pragma once
 
-#include <bitset>
+#include <algorithm>
 #include <queue>
 #include <iterator>
 #include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include "ecs/ChunkedArray.hh"
 #include "ecs/Common.hh"
+#include "ecs/ComponentContainers.hh"
+#include "ecs/SoaArray.hh"
 #include "Entity.hh"
 
-#define MAX_COMPONENTS 64
-
 
 namespace ecs
 {
@@ -27,12 +30,21 @@ namespace ecs
 			bool operator==(const Iterator &other);
 			bool operator!=(const Iterator &other);
 			Entity::Id operator*();
+
+			// index into the pool of the entity the iterator is at
+			size_t Index() const;
+			// jump straight to @compIndex, which must not be past the end of the pool
+			void Seek(size_t compIndex);
+			const BaseComponentPool &Pool() const;
 		private:
 			BaseComponentPool &pool;
 			size_t compIndex;
 		};
 
 		ComponentPoolEntityCollection(BaseComponentPool &pool);
+
+		// only iterate over the first @size components of the pool
+		ComponentPoolEntityCollection(BaseComponentPool &pool, size_t size);
 		Iterator begin();
 		Iterator end();
 	private:
@@ -45,7 +57,11 @@ namespace ecs
 	class BaseComponentPool
 	{
 		friend class ComponentPoolEntityCollection::Iterator;
+		friend class ComponentManager;
+		friend class EntityManager;
 	public:
+		static const size_t INVALID_COMP_INDEX = static_cast<size_t>(-1);
+
 		/**
 		* Creating this lock will enable "soft remove" mode on the given ComponentPool.
 		* The destruction of this lock will re-enable normal deletion mode.
@@ -67,10 +83,24 @@ namespace ecs
 		virtual size_t Size() const = 0;
 		virtual ComponentPoolEntityCollection Entities() = 0;
 
+		// remove every component, must not be called while the pool is iterate locked
+		virtual void Clear() = 0;
+
 		// as long as the resultant lock is not destroyed, the order that iteration occurs
 		// over the components must stay the same.
 		virtual unique_ptr<IterateLock> CreateIterateLock() = 0;
 
+		// true while an IterateLock exists for this pool
+		virtual bool IterateLocked() const = 0;
+
+	protected:
+		// entities[i] is the Entity that owns the pool's i'th component
+		// or the "Null" Entity if that component has been soft removed.
+		vector<Entity::Id> entities;
+
+		// the ComponentManager's current change tick
+		const uint64 *changeTick = nullptr;
+
 	private:
 		// when toggleSoftRemove(true) is called then any Remove(e) calls
 		// must guarentee to not alter the internal ordering of components.
@@ -79,54 +109,258 @@ namespace ecs
 		virtual void toggleSoftRemove(bool enabled) = 0;
 
 		// method used by ComponentPoolEntityCollection::Iterator to find the next Entity
-		virtual Entity::Id entityAt(size_t compIndex) = 0;
+		Entity::Id entityAt(size_t compIndex) const;
+
+		// index of the entity's component, INVALID_COMP_INDEX if it has none
+		virtual size_t indexOf(Entity::Id e) const = 0;
+
+		// exchange the storage locations of 2 components.
+		// Must not be called while the pool is iterate locked.
+		virtual void swapComponents(size_t compIndexA, size_t compIndexB) = 0;
+
+	};
+
+	/**
+	 * How a ComponentPool lays out its components in memory
+	 */
+	enum class ComponentLayout
+	{
+		// a single vector, the fastest to iterate but growing it moves every component
+		Contiguous,
+		// fixed-size chunks, growing never moves the existing components
+		Chunked,
+		// one aligned array per field declared in the type's SoaFields, the components
+		// can then only be accessed through EntityManager::Columns()
+		StructOfArrays,
+	};
 
+	/**
+	 * How a ComponentPool stores its components and finds the component of an Entity
+	 */
+	enum class StorageEngine
+	{
+		// components in one array laid out according to ComponentLayout and found
+		// through a paged sparse set, the best choice for components many entities have
+		Dense,
+		// same as Dense except that entities are mapped to their component with a hash
+		// map, for components only a few entities spread over a wide range of indexes have
+		Sparse,
+		// only the entity's mask bit and id are stored, every entity shares one instance.
+		// Used by default for empty types that are trivially destructible.
+		Tag,
+		// at most one entity at a time has the component and it is stored inside the pool.
+		// Assigning it to a 2nd entity throws, as does moving it to another entity while
+		// iterating over the component type.
+		Singleton,
+	};
+
+	/**
+	 * Storage options used for every component type that StorageTraits isn't specialized for.
+	 * To change an option for a single type, specialize StorageTraits for it, inherit
+	 * DefaultStorageTraits and redeclare the option:
+	 *
+	 * namespace ecs
+	 * {
+	 *     template <>
+	 *     struct StorageTraits<Mesh> : DefaultStorageTraits
+	 *     {
+	 *         static constexpr ComponentLayout layout = ComponentLayout::Chunked;
+	 *     };
+	 * }
+	 */
+	struct DefaultStorageTraits
+	{
+		static constexpr StorageEngine engine = StorageEngine::Dense;
+		static constexpr ComponentLayout layout = ComponentLayout::Contiguous;
+
+		// approximate size in bytes of each chunk of a Chunked pool
+		static constexpr size_t chunkBytes = 16 * 1024;
+
+		// remember the change tick each component was added at and last accessed
+		// mutably at, so Each() can be filtered with Changed<T> and Added<T>.
+		// Costs 16 bytes per component. Not supported for the StructOfArrays layout.
+		static constexpr bool trackChanges = false;
+	};
+
+	template <typename CompType>
+	struct StorageTraits : DefaultStorageTraits
+	{
+		// only types without state or a destructor can share one instance unnoticed
+		static constexpr StorageEngine engine =
+			std::is_empty<CompType>::value && std::is_trivially_destructible<CompType>::value
+			? StorageEngine::Tag : StorageEngine::Dense;
 	};
 
 	/**
 	 * ComponentPool is a storage container for Entity components.
-	 * It stores all components with a vector and so it only grows when new components are added.
+	 * It stores all components with a vector (or with a ChunkedArray when the type's
+	 * StorageTraits ask for the Chunked layout) and so it only grows when new components are added.
 	 * It "recycles" and keeps storage unfragmented by swapping components to the end when they are removed
 	 * but does not guarantee the internal ordering of components based on insertion or Entity index.
 	 * It allows efficient iteration since there are no holes in its component storage.
 	 *
-	 * TODO-cs: an incremental allocator instead of a vector will be better once the number
-	 * components is very large; this should be implemeted.
+	 * Components are found for an Entity with a paged sparse set: the Entity's index selects
+	 * a page and a slot within it which holds the index of its component. Lookups are
+	 * therefore plain array reads and pages are only allocated for the ranges of Entity
+	 * indexes that have actually been given a component of this type.
+	 *
+	 * The type's StorageTraits select the StorageEngine: Sparse pools map entities with a hash
+	 * map instead of pages, Tag pools keep only the entity list and Singleton pools hold their
+	 * single component inline.
+	 *
+	 * With the Chunked layout growing the pool never moves components, while a vector may
+	 * move every component whenever it grows. A pointer to a Chunked component stays valid
+	 * until the pool reorders its components, which happens when:
+	 * - a component of the same type is removed (the last one moves into its place)
+	 * - the component is replaced by Assign() or Emplace() on an entity that already has one
+	 * - the type is in a component group and a component of any grouped type is added or
+	 *   removed, or the group is registered, since grouped components are swapped to keep
+	 *   the group's entities packed together
 	 */
+	template <typename CompType>
+	class SoaColumns;
+
 	template <typename CompType>
 	class ComponentPool : public BaseComponentPool
 	{
+		friend class SoaColumns<CompType>;
 
 	public:
 		ComponentPool();
 
-		// DO NOT CACHE THIS POINTER, a component's pointer may change over time
+		// construct the entity's component from the forwarded arguments
 		template <typename ...T>
-		CompType *NewComponent(Entity::Id e, T... args);
+		void NewComponent(Entity::Id e, T&&... args);
 
 		// DO NOT CACHE THIS POINTER, a component's pointer may change over time
+		// Not available for the StructOfArrays layout.
 		CompType *Get(Entity::Id e);
+
+		// same as Get() but doesn't count as a change for Changed<CompType> filters
+		const CompType *Get(Entity::Id e) const;
+
+		// make room for @count more components so that adding them doesn't reallocate
+		void Reserve(size_t count);
+
+		// Get the component stored at the given index of the pool (0 to Size() - 1)
+		// DO NOT CACHE THIS REFERENCE, a component's address may change over time
+		// Not available for the StructOfArrays layout.
+		CompType &At(size_t compIndex);
+
+		// same as At() but doesn't count as a change for Changed<CompType> filters
+		const CompType &At(size_t compIndex) const;
+
+		// true if the entity has a component that was added or accessed mutably
+		// (Get() or At()) at a change tick later than @since.
+		// Only available for types whose StorageTraits track changes.
+		bool ChangedSince(Entity::Id e, uint64 since) const;
+
+		// true if the entity has a component that was added at a change tick later than @since.
+		// Only available for types whose StorageTraits track changes.
+		bool AddedSince(Entity::Id e, uint64 since) const;
+
 		void Remove(Entity::Id e) override;
 		bool HasComponent(Entity::Id e) const override;
 		size_t Size() const override;
 		ComponentPoolEntityCollection Entities() override;
+		void Clear() override;
 
 		unique_ptr<BaseComponentPool::IterateLock> CreateIterateLock() override;
+		bool IterateLocked() const override;
 
 	private:
-		static const size_t INVALID_COMP_INDEX = static_cast<size_t>(-1);
+		// each sparse page maps 2^SPARSE_PAGE_BITS consecutive entity indexes
+		static const size_t SPARSE_PAGE_BITS = 12;
+		static const size_t SPARSE_PAGE_SIZE = static_cast<size_t>(1) << SPARSE_PAGE_BITS;
+		static const size_t SPARSE_PAGE_MASK = SPARSE_PAGE_SIZE - 1;
+
+		static constexpr StorageEngine ENGINE = StorageTraits<CompType>::engine;
+		static constexpr bool SOA = StorageTraits<CompType>::layout == ComponentLayout::StructOfArrays;
+		static constexpr bool TRACK_CHANGES = StorageTraits<CompType>::trackChanges;
+		static_assert(!(SOA && TRACK_CHANGES), "changes can't be tracked for the StructOfArrays layout");
+
+		typedef typename std::conditional<ENGINE == StorageEngine::Tag,
+			TagArray<CompType>,
+			typename std::conditional<ENGINE == StorageEngine::Singleton,
+				SingletonArray<CompType>,
+				typename std::conditional<StorageTraits<CompType>::layout == ComponentLayout::Chunked,
+					ChunkedArray<CompType, StorageTraits<CompType>::chunkBytes>,
+					typename std::conditional<StorageTraits<CompType>::layout == ComponentLayout::StructOfArrays,
+						SoaArray<CompType>,
+						vector<CompType> >::type>::type>::type>::type Storage;
+
+		// components[i] belongs to the Entity at entities[i]
+		Storage components;
+
+		// change tick components[i] was added at and last accessed mutably at,
+		// both empty unless TRACK_CHANGES
+		vector<uint64> addedTicks;
+		vector<uint64> changedTicks;
+
+		// entity index -> component index, INVALID_COMP_INDEX if the entity
+		// has no component. A null page means none of its entities have one.
+		vector<unique_ptr<size_t[]> > sparsePages;
+
+		// entity index -> component index for the Sparse engine, used instead of sparsePages
+		GLOMERATE_MAP_TYPE<eid_t, size_t> sparseIndexes;
 
-		vector<std::pair<Entity::Id, CompType> > components;
-		size_t lastCompIndex;
-		GLOMERATE_MAP_TYPE<eid_t, size_t> entIndexToCompIndex;
 		bool softRemoveMode;
-		std::queue<size_t> softRemoveCompIndexes;
+		// highest index first so that removing one never moves another soft removed
+		// component out from under its queued index
+		std::priority_queue<size_t> softRemoveCompIndexes;
 
 		void toggleSoftRemove(bool enabled) override;
 
+		// stamp the component with the current change tick if TRACK_CHANGES
+		void markChanged(size_t compIndex);
+
 		void softRemove(size_t compIndex);
 		void remove(size_t compIndex);
 
-		Entity::Id entityAt(size_t compIndex) override;
+		// a SoaArray has no elements to assign so it moves and swaps the fields itself
+		void moveComponent(size_t to, size_t from, std::false_type);
+		void moveComponent(size_t to, size_t from, std::true_type);
+		void swapStoredComponents(size_t a, size_t b, std::false_type);
+		void swapStoredComponents(size_t a, size_t b, std::true_type);
+
+		// returns INVALID_COMP_INDEX if the entity index has no component
+		size_t compIndexOf(eid_t entIndex) const;
+
+		// allocates the sparse page for the entity index if it doesn't exist yet
+		void setCompIndex(eid_t entIndex, size_t compIndex);
+
+		size_t indexOf(Entity::Id e) const override;
+		void swapComponents(size_t compIndexA, size_t compIndexB) override;
+	};
+
+	/**
+	 * The columns of a component type stored with the StructOfArrays layout, returned by
+	 * EntityManager::Columns().  Row i of every column belongs to the entity Entities()[i].
+	 * Adding or removing components of the type invalidates the spans it returned.
+	 */
+	template <typename CompType>
+	class SoaColumns
+	{
+	public:
+		template <size_t Field>
+		using FieldType = typename SoaArray<CompType>::template FieldType<Field>;
+
+		SoaColumns(ComponentPool<CompType> &pool);
+
+		size_t Size() const;
+
+		// entity of each row, Entity::Id() for rows whose component was removed while
+		// iterating over the component type; such rows go away once iteration is done
+		Span<const Entity::Id> Entities() const;
+
+		// the values of the field at index @Field of the type's SoaFields::Members()
+		template <size_t Field>
+		Span<FieldType<Field> > Column() const;
+
+		// row of the entity's component, throws a runtime_error if it doesn't have one
+		size_t IndexOf(Entity::Id e) const;
+
+	private:
+		ComponentPool<CompType> *pool;
 	};
 }
@@ -16,6 +16,16 @@ namespace ecs
 	}
 }
 
+// BaseComponentPool
+namespace ecs
+{
+	inline Entity::Id BaseComponentPool::entityAt(size_t compIndex) const
+	{
+		Assert(compIndex < entities.size());
+		return entities[compIndex];
+	}
+}
+
 // ComponentPoolEntityCollection
 namespace ecs
 {
@@ -27,6 +37,12 @@ namespace ecs
 		lastCompIndex = pool.Size() - 1;
 	}
 
+	inline ComponentPoolEntityCollection::ComponentPoolEntityCollection(BaseComponentPool &pool, size_t size)
+		: pool(pool), lastCompIndex(size - 1)
+	{
+		Assert(size <= pool.Size(), "collection cannot be larger than its pool");
+	}
+
 	inline ComponentPoolEntityCollection::Iterator ComponentPoolEntityCollection::begin()
 	{
 		return ComponentPoolEntityCollection::Iterator(pool, 0);
@@ -65,6 +81,22 @@ namespace ecs
 		return pool.entityAt(compIndex);
 	}
 
+	inline size_t ComponentPoolEntityCollection::Iterator::Index() const
+	{
+		return compIndex;
+	}
+
+	inline void ComponentPoolEntityCollection::Iterator::Seek(size_t compIndex)
+	{
+		Assert(compIndex <= pool.Size(), "cannot seek past the end of the component pool");
+		this->compIndex = compIndex;
+	}
+
+	inline const BaseComponentPool &ComponentPoolEntityCollection::Iterator::Pool() const
+	{
+		return pool;
+	}
+
 	inline bool ComponentPoolEntityCollection::Iterator::operator==(
 		const ComponentPoolEntityCollection::Iterator &other)
 	{
@@ -81,10 +113,18 @@ namespace ecs
 // ComponentPool
 namespace ecs
 {
+	template <typename CompType>
+	constexpr StorageEngine ComponentPool<CompType>::ENGINE;
+
+	template <typename CompType>
+	constexpr bool ComponentPool<CompType>::SOA;
+
+	template <typename CompType>
+	constexpr bool ComponentPool<CompType>::TRACK_CHANGES;
+
 	template <typename CompType>
 	ComponentPool<CompType>::ComponentPool()
 	{
-		lastCompIndex = static_cast<size_t>(-1);
 		softRemoveMode = false;
 	}
 
@@ -95,49 +135,132 @@ namespace ecs
 	}
 
 	template <typename CompType>
-	template <typename ...T>
-	CompType *ComponentPool<CompType>::NewComponent(Entity::Id e, T... args)
+	bool ComponentPool<CompType>::IterateLocked() const
 	{
-		size_t newCompIndex = lastCompIndex + 1;
-		lastCompIndex = newCompIndex;
+		return softRemoveMode;
+	}
 
-		if (components.size() == newCompIndex)
+	template <typename CompType>
+	template <typename ...T>
+	void ComponentPool<CompType>::NewComponent(Entity::Id e, T&&... args)
+	{
+		size_t newCompIndex = components.size();
+		components.emplace_back(std::forward<T>(args)...);
+		entities.push_back(e);
+		if (TRACK_CHANGES)
 		{
-			components.emplace_back(e, CompType(args...));
+			addedTicks.push_back(*changeTick);
+			changedTicks.push_back(*changeTick);
 		}
-		else
+
+		setCompIndex(e.Index(), newCompIndex);
+	}
+
+	template <typename CompType>
+	CompType *ComponentPool<CompType>::Get(Entity::Id e)
+	{
+		static_assert(!SOA, "components stored as a struct of arrays can only be accessed with EntityManager::Columns()");
+		size_t compIndex = compIndexOf(e.Index());
+		if (compIndex == ComponentPool<CompType>::INVALID_COMP_INDEX)
 		{
-			components.at(newCompIndex).second = CompType(args...);
+			return nullptr;
 		}
 
-		components.at(newCompIndex).first = e;
-		entIndexToCompIndex[e.Index()] = newCompIndex;
-
-		return &components.at(newCompIndex).second;
+		markChanged(compIndex);
+		return &components[compIndex];
 	}
 
 	template <typename CompType>
-	CompType *ComponentPool<CompType>::Get(Entity::Id e)
+	const CompType *ComponentPool<CompType>::Get(Entity::Id e) const
 	{
-		if (!HasComponent(e))
+		static_assert(!SOA, "components stored as a struct of arrays can only be accessed with EntityManager::Columns()");
+		size_t compIndex = compIndexOf(e.Index());
+		if (compIndex == ComponentPool<CompType>::INVALID_COMP_INDEX)
 		{
 			return nullptr;
 		}
 
-		size_t compIndex = entIndexToCompIndex.at(e.Index());
-		return &components.at(compIndex).second;
+		return &components[compIndex];
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::Reserve(size_t count)
+	{
+		size_t capacity = components.size() + count;
+		components.reserve(capacity);
+		entities.reserve(capacity);
+		if (TRACK_CHANGES)
+		{
+			addedTicks.reserve(capacity);
+			changedTicks.reserve(capacity);
+		}
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::Clear()
+	{
+		Assert(!softRemoveMode, "cannot clear a pool while it is iterate locked");
+
+		components.clear();
+		entities.clear();
+		addedTicks.clear();
+		changedTicks.clear();
+		sparsePages.clear();
+		sparseIndexes.clear();
+	}
+
+	template <typename CompType>
+	CompType &ComponentPool<CompType>::At(size_t compIndex)
+	{
+		static_assert(!SOA, "components stored as a struct of arrays can only be accessed with EntityManager::Columns()");
+		Assert(compIndex < components.size(), "component index is past the end of the pool");
+		markChanged(compIndex);
+		return components[compIndex];
+	}
+
+	template <typename CompType>
+	const CompType &ComponentPool<CompType>::At(size_t compIndex) const
+	{
+		static_assert(!SOA, "components stored as a struct of arrays can only be accessed with EntityManager::Columns()");
+		Assert(compIndex < components.size(), "component index is past the end of the pool");
+		return components[compIndex];
+	}
+
+	template <typename CompType>
+	bool ComponentPool<CompType>::ChangedSince(Entity::Id e, uint64 since) const
+	{
+		static_assert(TRACK_CHANGES, "changes are only tracked for types whose StorageTraits set trackChanges");
+		size_t compIndex = compIndexOf(e.Index());
+		return compIndex != ComponentPool<CompType>::INVALID_COMP_INDEX && changedTicks[compIndex] > since;
+	}
+
+	template <typename CompType>
+	bool ComponentPool<CompType>::AddedSince(Entity::Id e, uint64 since) const
+	{
+		static_assert(TRACK_CHANGES, "changes are only tracked for types whose StorageTraits set trackChanges");
+		size_t compIndex = compIndexOf(e.Index());
+		return compIndex != ComponentPool<CompType>::INVALID_COMP_INDEX && addedTicks[compIndex] > since;
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::markChanged(size_t compIndex)
+	{
+		if (TRACK_CHANGES)
+		{
+			changedTicks[compIndex] = *changeTick;
+		}
 	}
 
 	template <typename CompType>
 	void ComponentPool<CompType>::Remove(Entity::Id e)
 	{
-		if (!HasComponent(e))
+		size_t removeIndex = compIndexOf(e.Index());
+		if (removeIndex == ComponentPool<CompType>::INVALID_COMP_INDEX)
 		{
 			throw std::runtime_error("cannot remove component because the entity does not have one");
 		}
 
-		size_t removeIndex = entIndexToCompIndex.at(e.Index());
-		entIndexToCompIndex.at(e.Index()) = ComponentPool<CompType>::INVALID_COMP_INDEX;
+		setCompIndex(e.Index(), ComponentPool<CompType>::INVALID_COMP_INDEX);
 
 		if (softRemoveMode)
 		{
@@ -152,24 +275,59 @@ namespace ecs
 	template <typename CompType>
 	void ComponentPool<CompType>::remove(size_t compIndex)
 	{
+		size_t lastCompIndex = components.size() - 1;
 		if (compIndex != lastCompIndex)
 		{
-			// Swap this component to the end
-			auto validComponentPair = components.at(lastCompIndex);
-			components.at(lastCompIndex) = components.at(compIndex);
-			components.at(compIndex) = validComponentPair;
+			// Move the last component into the removed one's place
+			moveComponent(compIndex, lastCompIndex, std::integral_constant<bool, SOA>());
+			entities.at(compIndex) = entities[lastCompIndex];
+			if (TRACK_CHANGES)
+			{
+				addedTicks[compIndex] = addedTicks[lastCompIndex];
+				changedTicks[compIndex] = changedTicks[lastCompIndex];
+			}
+			Entity::Id validEntity = entities.at(compIndex);
 
 			// update the entity -> component index mapping of swapped component
 			// if it's entity still exists
 			// (Entity could have been deleted while iterating over entities so the component was only soft-deleted till now)
-			eid_t entityIndex = validComponentPair.first.Index();
-			if (entIndexToCompIndex.count(entityIndex) > 0)
+			if (validEntity != Entity::Id())
 			{
-				entIndexToCompIndex.at(entityIndex) = compIndex;
+				setCompIndex(validEntity.Index(), compIndex);
 			}
 		}
 
-		lastCompIndex--;
+		components.pop_back();
+		entities.pop_back();
+		if (TRACK_CHANGES)
+		{
+			addedTicks.pop_back();
+			changedTicks.pop_back();
+		}
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::moveComponent(size_t to, size_t from, std::false_type)
+	{
+		components[to] = std::move(components[from]);
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::moveComponent(size_t to, size_t from, std::true_type)
+	{
+		components.Move(to, from);
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::swapStoredComponents(size_t a, size_t b, std::false_type)
+	{
+		std::swap(components[a], components[b]);
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::swapStoredComponents(size_t a, size_t b, std::true_type)
+	{
+		components.Swap(a, b);
 	}
 
 	template <typename CompType>
@@ -180,21 +338,69 @@ namespace ecs
 		// "Null" Entities will never be iterated over
 		Assert(compIndex < components.size());
 
-		components.at(compIndex).first = Entity::Id();
+		entities.at(compIndex) = Entity::Id();
 		softRemoveCompIndexes.push(compIndex);
 	}
 
 	template <typename CompType>
 	bool ComponentPool<CompType>::HasComponent(Entity::Id e) const
 	{
-		auto compIndex = entIndexToCompIndex.find(e.Index());
-		return compIndex != entIndexToCompIndex.end() && compIndex->second != ComponentPool<CompType>::INVALID_COMP_INDEX;
+		return compIndexOf(e.Index()) != ComponentPool<CompType>::INVALID_COMP_INDEX;
+	}
+
+	template <typename CompType>
+	size_t ComponentPool<CompType>::compIndexOf(eid_t entIndex) const
+	{
+		if (ENGINE == StorageEngine::Sparse)
+		{
+			auto it = sparseIndexes.find(entIndex);
+			return it == sparseIndexes.end() ? ComponentPool<CompType>::INVALID_COMP_INDEX : it->second;
+		}
+
+		size_t page = entIndex >> SPARSE_PAGE_BITS;
+		if (page >= sparsePages.size() || !sparsePages[page])
+		{
+			return ComponentPool<CompType>::INVALID_COMP_INDEX;
+		}
+		return sparsePages[page][entIndex & SPARSE_PAGE_MASK];
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::setCompIndex(eid_t entIndex, size_t compIndex)
+	{
+		if (ENGINE == StorageEngine::Sparse)
+		{
+			if (compIndex == ComponentPool<CompType>::INVALID_COMP_INDEX)
+			{
+				sparseIndexes.erase(entIndex);
+			}
+			else
+			{
+				sparseIndexes[entIndex] = compIndex;
+			}
+			return;
+		}
+
+		size_t page = entIndex >> SPARSE_PAGE_BITS;
+		if (page >= sparsePages.size())
+		{
+			sparsePages.resize(page + 1);
+		}
+
+		if (!sparsePages[page])
+		{
+			const size_t invalid = ComponentPool<CompType>::INVALID_COMP_INDEX;
+			sparsePages[page].reset(new size_t[SPARSE_PAGE_SIZE]);
+			std::fill(sparsePages[page].get(), sparsePages[page].get() + SPARSE_PAGE_SIZE, invalid);
+		}
+
+		sparsePages[page][entIndex & SPARSE_PAGE_MASK] = compIndex;
 	}
 
 	template <typename CompType>
 	size_t ComponentPool<CompType>::Size() const
 	{
-		return lastCompIndex + 1;
+		return components.size();
 	}
 
 	template <typename CompType>
@@ -217,7 +423,7 @@ namespace ecs
 			// must perform proper removes for everything that has been "soft removed"
 			while (!softRemoveCompIndexes.empty())
 			{
-				size_t compIndex = softRemoveCompIndexes.front();
+				size_t compIndex = softRemoveCompIndexes.top();
 				softRemoveCompIndexes.pop();
 				remove(compIndex);
 			}
@@ -227,10 +433,31 @@ namespace ecs
 	}
 
 	template <typename CompType>
-	Entity::Id ComponentPool<CompType>::entityAt(size_t compIndex)
+	size_t ComponentPool<CompType>::indexOf(Entity::Id e) const
 	{
-		Assert(compIndex < components.size());
-		return components[compIndex].first;
+		return compIndexOf(e.Index());
+	}
+
+	template <typename CompType>
+	void ComponentPool<CompType>::swapComponents(size_t compIndexA, size_t compIndexB)
+	{
+		Assert(!softRemoveMode, "cannot reorder components while iterating over them");
+		Assert(compIndexA < components.size() && compIndexB < components.size());
+
+		if (compIndexA == compIndexB)
+		{
+			return;
+		}
+
+		swapStoredComponents(compIndexA, compIndexB, std::integral_constant<bool, SOA>());
+		std::swap(entities[compIndexA], entities[compIndexB]);
+		if (TRACK_CHANGES)
+		{
+			std::swap(addedTicks[compIndexA], addedTicks[compIndexB]);
+			std::swap(changedTicks[compIndexA], changedTicks[compIndexB]);
+		}
+		setCompIndex(entities[compIndexA].Index(), compIndexA);
+		setCompIndex(entities[compIndexB].Index(), compIndexB);
 	}
 
 	template <typename CompType>
@@ -239,3 +466,43 @@ namespace ecs
 		return ComponentPoolEntityCollection(*this);
 	}
 }
+
+// SoaColumns
+namespace ecs
+{
+	template <typename CompType>
+	SoaColumns<CompType>::SoaColumns(ComponentPool<CompType> &pool) : pool(&pool)
+	{
+	}
+
+	template <typename CompType>
+	size_t SoaColumns<CompType>::Size() const
+	{
+		return pool->Size();
+	}
+
+	template <typename CompType>
+	Span<const Entity::Id> SoaColumns<CompType>::Entities() const
+	{
+		return Span<const Entity::Id>(pool->entities);
+	}
+
+	template <typename CompType>
+	template <size_t Field>
+	Span<typename SoaColumns<CompType>::template FieldType<Field> > SoaColumns<CompType>::Column() const
+	{
+		return pool->components.template Column<Field>();
+	}
+
+	template <typename CompType>
+	size_t SoaColumns<CompType>::IndexOf(Entity::Id e) const
+	{
+		size_t compIndex = pool->indexOf(e);
+		if (compIndex == ComponentPool<CompType>::INVALID_COMP_INDEX)
+		{
+			throw runtime_error("entity does not have a component of type "
+				+ string(typeid(CompType).name()));
+		}
+		return compIndex;
+	}
+}
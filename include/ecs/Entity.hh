@@ -37,6 +37,11 @@ namespace ecs
 			// the rest of the bits are for the generation
 			static const eid_t INDEX_MASK = ((eid_t)1 << INDEX_BITS) - 1;
 
+			// the largest generation is reserved for the placeholder ids given out by
+			// CommandBuffer::NewEntity() so the EntityManager never gives it to an entity
+			static const gen_t PLACEHOLDER_GENERATION =
+				static_cast<gen_t>(((eid_t)1 << (sizeof(eid_t) * 8 - INDEX_BITS)) - 1);
+
 			Id() : Id(NULL_ID) {};
 			Id(const Id &) = default;
 			Id(eid_t index, gen_t generation);
@@ -94,8 +99,8 @@ namespace ecs
 
 		/**
 		 * Remove the given entity from the ECS.
-		 * THIS MAKES NO GUARENTEE to call destructors on components that were assigned
-		 * to this entity.
+		 * Its components are destroyed right away, or once iteration over their
+		 * component type finishes if the entity is destroyed while iterating.
 		 */
 		void Destroy();
 
@@ -116,6 +121,15 @@ namespace ecs
 		template <typename CompType, typename ...T>
 		Handle<CompType> Assign(T... args);
 
+		/**
+		 * Same as Assign() except that the arguments are perfectly forwarded to
+		 * CompType's constructor so the component is constructed exactly once,
+		 * in place.  Use this for components that are expensive to copy or that
+		 * can only be moved.
+		 */
+		template <typename CompType, typename ...T>
+		Handle<CompType> Emplace(T&&... args);
+
 		/**
 		 * Remove the given component type from this entity.
 		 * Throws an error if it doesn't have this component type.
@@ -155,6 +169,12 @@ namespace ecs
 		template <typename Event>
 		void Emit(const Event &event);
 
+		/**
+		 * Queue an Event on this Entity for EntityManager::DispatchQueued().
+		 */
+		template <typename Event>
+		void Enqueue(const Event &event);
+
 	private:
 		EntityManager *em;
 		Entity::Id eid;
@@ -108,7 +108,16 @@ namespace ecs
 		if (em == nullptr) {
 			throw runtime_error("Cannot assign component to NULL Entity");
 		}
-		return em->Assign<CompType>(this->eid, args...);
+		return em->Emplace<CompType>(this->eid, std::move(args)...);
+	}
+
+	template <typename CompType, typename ...T>
+	Handle<CompType> Entity::Emplace(T&&... args)
+	{
+		if (em == nullptr) {
+			throw runtime_error("Cannot assign component to NULL Entity");
+		}
+		return em->Emplace<CompType>(this->eid, std::forward<T>(args)...);
 	}
 
 	template <typename CompType>
@@ -181,4 +190,10 @@ namespace ecs
 	{
 		em->Emit(this->eid, event);
 	}
+
+	template <typename Event>
+	void Entity::Enqueue(const Event &event)
+	{
+		em->Enqueue(this->eid, event);
+	}
 }
@@ -1,18 +1,26 @@
 #pragma once
 
-#include <queue>
+#include <atomic>
 #include <iostream>
 #include <functional>
 #include <stdexcept>
 #include <sstream>
 #include <functional>
-#include <boost/signals2.hpp>
+#include <tuple>
 
 #include "ecs/Common.hh"
+#include "ChangeFilter.hh"
+#include "CommandBuffer.hh"
 #include "ComponentManager.hh"
 #include "Entity.hh"
+#include "EventQueue.hh"
+#include "EventStage.hh"
 #include "Handle.hh"
+#include "MaskFilter.hh"
+#include "Signal.hh"
 #include "Subscription.hh"
+#include "TypeIds.hh"
+#include "WorkerPool.hh"
 
 /**
  * how big the recycle pool must be before it starts being used instead
@@ -26,8 +34,13 @@
 
 namespace ecs
 {
+	template <typename ...CompTypes>
+	class Query;
+
 	class EntityManager
 	{
+		template <typename ...CompTypes>
+		friend class Query;
 	public:
 		class EntityCollection
 		{
@@ -35,7 +48,7 @@ namespace ecs
 			class Iterator : public std::iterator<std::input_iterator_tag, Entity>
 			{
 			public:
-				Iterator(EntityManager &em, const ComponentManager::ComponentMask &compMask,
+				Iterator(EntityManager &em, const ComponentManager::ComponentMask &compMask, const bool *allMatch,
 						 ComponentPoolEntityCollection *compEntColl, ComponentPoolEntityCollection::Iterator compIt);
 				Iterator &operator++();
 				bool operator==(const Iterator &other);
@@ -44,17 +57,30 @@ namespace ecs
 			private:
 				EntityManager &em;
 				const ComponentManager::ComponentMask &compMask;
+				const bool *allMatch;
+
+				bool matches(Entity::Id e) const;
 				ComponentPoolEntityCollection *compEntColl;
 				ComponentPoolEntityCollection::Iterator compIt;
+
+				// entities after compIt that matched when they were last filtered, bit i is
+				// the entity at pendingBase + i. Only valid while the mask version is unchanged.
+				uint64 pendingMatches = 0;
+				size_t pendingBase = 0;
+				uint64 pendingVersion = 0;
 			};
 
 			// An IterateLock on compEntColl's component pool is needed so that
 			// if any components are deleted they do not affect the ordering of any of the other
 			// components in this pool (normally deletions are a swap-to-back operation)
 			// this lock releases on destructions so it's okay if Exceptions are raised when iterating
+			//
+			// While *@allMatch is true every entity in compEntColl is known to match compMask
+			// so entities don't need to be checked against it
 			EntityCollection(EntityManager &em, const ComponentManager::ComponentMask &compMask,
 							 ComponentPoolEntityCollection compEntColl,
-							 unique_ptr<BaseComponentPool::IterateLock> &&iLock);
+							 unique_ptr<BaseComponentPool::IterateLock> &&iLock,
+							 const bool *allMatch = nullptr);
 			Iterator begin();
 			Iterator end();
 		private:
@@ -62,6 +88,7 @@ namespace ecs
 			ComponentManager::ComponentMask compMask;
 			ComponentPoolEntityCollection compEntColl;
 			unique_ptr<BaseComponentPool::IterateLock> iLock;
+			const bool *allMatch;
 		};
 
 		EntityManager();
@@ -71,15 +98,67 @@ namespace ecs
 		 */
 		Entity NewEntity();
 
+		/**
+		 * Add @count new entities to the ECS.  This is the same as calling NewEntity()
+		 * @count times but the entity storage is only grown once.
+		 * Returns the ids of the new entities.
+		 */
+		vector<Entity::Id> NewEntities(size_t count);
+
+		/**
+		 * Add @count new entities to the ECS which each get a copy of the given components.
+		 * Each component type's storage is only looked up and grown once.
+		 *
+		 * Ex Usage:
+		 * ```
+		 * entMgr.CreateMany<Position, Velocity>(1000, Position(0, 0), Velocity(1, 0));
+		 * ```
+		 * Returns the ids of the new entities.
+		 */
+		template <typename ...CompTypes>
+		vector<Entity::Id> CreateMany(size_t count, const CompTypes &... components);
+
+		/**
+		 * Reserve the Id of a new entity. Unlike NewEntity() this may be called from
+		 * many threads at once, including from ParallelEach() callbacks, as long as no
+		 * thread is creating or destroying entities at the same time. Reserving is
+		 * a single atomic increment and reuses indexes of destroyed entities.
+		 *
+		 * The entity is not valid until FlushReservedEntities() is called, which
+		 * NewEntity(), NewEntities() and Flush() also do. Throws an std::runtime_error
+		 * like NewEntity() if there are no entity indexes left.
+		 */
+		Entity::Id ReserveEntity();
+
+		/**
+		 * Make every entity reserved by ReserveEntity() valid.
+		 */
+		void FlushReservedEntities();
+
 		/**
 		 * Remove the given entity from the ECS.
-		 * THIS MAKES NO GUARENTEE to call destructors on components that were assigned
-		 * to this entity.
+		 * Its components are destroyed right away, or once iteration over their
+		 * component type finishes if the entity is destroyed while iterating.
 		 */
 		void Destroy(Entity::Id e);
 
+		/**
+		 * Remove all of the given entities from the ECS.  Equivalent to calling
+		 * Destroy() on each of them but faster when there are no subscribers to
+		 * EntityDestruction events since no events need to be emitted.
+		 *
+		 * Throws an std::invalid_argument without destroying any of the entities
+		 * if any of them are not valid.  An entity given more than once is only
+		 * destroyed once.
+		 */
+		void DestroyBatch(Span<const Entity::Id> entities);
+
 		/**
 		 * Equivalent way of calling Destroy() on every Entity in the ECS.
+		 *
+		 * When there are no subscribers to EntityDestruction events and nothing
+		 * is being iterated over, all components are cleared at once instead of
+		 * being removed from each entity.
 		 */
 		void DestroyAll();
 
@@ -91,6 +170,16 @@ namespace ecs
 		 */
 		bool Valid(Entity::Id e) const;
 
+		/**
+		 * Apply all of the changes recorded in @buffer and then clear it.
+		 *
+		 * New entities are created first, then components are assigned and removed
+		 * one component type at a time in the order they were recorded for that type,
+		 * and finally entities are destroyed.  Changes to entities that are no longer
+		 * valid are skipped.  If a change throws then the rest of the buffer is discarded.
+		 */
+		void Flush(CommandBuffer &buffer);
+
 		/**
 		 * Construct a new component of type "CompType" with the given arguments
 		 * and attach it to the entity.
@@ -100,6 +189,15 @@ namespace ecs
 		template <typename CompType, typename ...T>
 		Handle<CompType> Assign(Entity::Id e, T... args);
 
+		/**
+		 * Same as Assign() except that the arguments are perfectly forwarded to
+		 * CompType's constructor so the component is constructed exactly once,
+		 * in place.  Use this for components that are expensive to copy or that
+		 * can only be moved.
+		 */
+		template <typename CompType, typename ...T>
+		Handle<CompType> Emplace(Entity::Id e, T&&... args);
+
 		/**
 		 * Remove the component of type "CompType" from this entity.
 		 * Throws an error if it doesn't have this component type.
@@ -150,6 +248,28 @@ namespace ecs
 		template <typename ...CompTypes>
 		ComponentManager::ComponentMask &SetComponentMask(ComponentManager::ComponentMask &mask);
 
+		/**
+		 * Store the given component types together like a table with one column per
+		 * component type: the components of every entity that has all of the types are
+		 * kept packed at the front of each type's storage in the same order.
+		 *
+		 * Iterating over entities with (at least) all of these components then only
+		 * visits entities that match instead of scanning the smallest component pool
+		 * and testing each of its entities. Use this for component combinations that
+		 * are iterated over often.
+		 *
+		 * The cost is that adding or removing one of these components from an entity
+		 * moves its components within the group's storage.  Changes made while the
+		 * group is being iterated over can't move components, so the group is
+		 * re-packed the next time it is used instead.
+		 *
+		 * A component type can only belong to one group.  Any types that have not
+		 * been registered yet will be registered.  Throws an std::runtime_error if
+		 * any of the types are already in a group.
+		 */
+		template <typename ...CompTypes>
+		void RegisterComponentGroup();
+
 		/**
 		 * Used to iterate over all entities that have the given components.
 		 *
@@ -179,6 +299,122 @@ namespace ecs
 		 */
 		EntityCollection EntitiesWith(ComponentManager::ComponentMask compMask);
 
+		/**
+		 * Call @callback for every entity that has all of the given components
+		 * with a reference to each of those components.
+		 *
+		 * Ex Usage:
+		 * ```
+		 * entMgr.Each<Position, Velocity>([](Entity e, Position &pos, Velocity &vel)
+		 * {
+		 *      pos.x += vel.dx;
+		 * });
+		 * ```
+		 * This is faster than EntitiesWith() since the component storage for each
+		 * type is found once up front and components are read straight out of it
+		 * instead of being looked up for each entity through a Handle.
+		 *
+		 * The same rules apply for creating and removing entities and components during
+		 * iteration as for EntitiesWith(). The references passed to @callback are only
+		 * valid until it returns or until a component of the same type is added.
+		 */
+		template <typename ...CompTypes, typename Func>
+		void Each(Func callback);
+
+		/**
+		 * Same as Each() except that only the entities whose FilterType component
+		 * changed or was added after a change tick are visited. FilterType doesn't
+		 * need to be one of CompTypes. Ex, to send only the positions that changed
+		 * since the last time they were sent:
+		 * ```
+		 * entMgr.Each<Position>(ecs::Changed<Position>(lastSent), [](Entity e, Position &pos)
+		 * {
+		 *      send(e, pos);
+		 * });
+		 * lastSent = entMgr.AdvanceChangeTick();
+		 * ```
+		 */
+		template <typename ...CompTypes, typename FilterType, typename Func>
+		void Each(const Changed<FilterType> &filter, Func callback);
+
+		template <typename ...CompTypes, typename FilterType, typename Func>
+		void Each(const Added<FilterType> &filter, Func callback);
+
+		/**
+		 * Components of types whose StorageTraits track changes are stamped with the
+		 * current change tick when they are added or accessed mutably (through a Handle
+		 * other than Handle::Read(), or given to an Each() callback that takes it by
+		 * non-const reference).
+		 */
+		uint64 ChangeTick() const;
+
+		/**
+		 * End the current change tick and return it. Changes from now on are stamped
+		 * with a later tick, so the result is the "since" to give Changed and Added
+		 * filters to see the changes made after this call.
+		 */
+		uint64 AdvanceChangeTick();
+
+		/**
+		 * Same as Each() except that the matching entities are split into chunks of
+		 * @grainSize entities which are processed in parallel by the worker threads
+		 * (see SetWorkerThreadCount()) and the calling thread.  Returns once every
+		 * chunk is done.
+		 *
+		 * @callback is called from several threads at once, so it must only modify
+		 * the components given to it and must not touch data that other calls may
+		 * be modifying.  Structural changes (creating or destroying entities, adding or
+		 * removing components, registering component types or groups) and starting
+		 * another iteration are not thread-safe so they throw an std::runtime_error
+		 * until ParallelEach() returns.  If @callback throws then any chunks that
+		 * haven't started are skipped and the exception is rethrown here.
+		 *
+		 * @callback may Emit() and Enqueue() events. They are staged per thread and
+		 * delivered by the calling thread just before ParallelEach() returns, in the
+		 * same order as if Each() had been called instead.
+		 */
+		template <typename ...CompTypes, typename Func>
+		void ParallelEach(Func callback, size_t grainSize = 1024);
+
+		/**
+		 * Same as ParallelEach() except that only the entities whose FilterType
+		 * component changed or was added after a change tick are visited, see Each().
+		 */
+		template <typename ...CompTypes, typename FilterType, typename Func>
+		void ParallelEach(const Changed<FilterType> &filter, Func callback, size_t grainSize = 1024);
+
+		template <typename ...CompTypes, typename FilterType, typename Func>
+		void ParallelEach(const Added<FilterType> &filter, Func callback, size_t grainSize = 1024);
+
+		/**
+		 * Create a Query for the entities that have all of the given components.
+		 * Queries should be kept and reused instead of calling EntitiesWith(),
+		 * Each() or ParallelEach() every time. See Query.
+		 */
+		template <typename ...CompTypes>
+		Query<CompTypes...> CreateQuery();
+
+		/**
+		 * Access the components of a type stored with the StructOfArrays layout
+		 * (see StorageTraits and SoaFields) one field at a time, ex:
+		 *
+		 * auto positions = entityManager.Columns<Position>();
+		 * ecs::Span<float> xs = positions.Column<0>();
+		 * ecs::Span<float> ys = positions.Column<1>();
+		 * for (size_t i = 0; i < xs.Size(); ++i) { xs[i] *= 2; ys[i] *= 2; }
+		 *
+		 * Unlike Each() this only walks the columns of one type, rows of different
+		 * types must be matched up with SoaColumns::Entities() and IndexOf().
+		 */
+		template <typename CompType>
+		SoaColumns<CompType> Columns();
+
+		/**
+		 * Set how many threads ParallelEach() uses in addition to the calling thread.
+		 * Defaults to one less than the number of hardware threads.
+		 */
+		void SetWorkerThreadCount(size_t count);
+
 		/**
 		 * Register @callback to be called whenever an event of type Event
 		 * occurs on ANY Entity.
@@ -205,7 +441,8 @@ namespace ecs
 
 		/**
 		 * Emit an event associated with the given entity. This will trigger
-		 * any callbacks that have subscribed to this kind of event.
+		 * any callbacks that have subscribed to this kind of event, right away
+		 * unless it's called from ParallelEach() (see ParallelEach()).
 		 */
 		template <typename Event>
 		void Emit(Entity::Id e, const Event &event);
@@ -216,66 +453,211 @@ namespace ecs
 		template <typename Event>
 		void Emit(const Event &event);
 
+		/**
+		 * Queue an event associated with the given entity instead of emitting it
+		 * right away. Queued events are stored contiguously per event type until
+		 * DispatchQueued<Event>() or DispatchAll() emits them in the order they
+		 * were queued. Events of entities destroyed in the meantime are dropped.
+		 */
+		template <typename Event>
+		void Enqueue(Entity::Id e, const Event &event);
+
+		/**
+		 * Deliver the events of type Event queued with Enqueue(), first to the
+		 * batch subscribers of SubscribeBatch() and then one at a time to the
+		 * subscribers of Subscribe(). Events queued by the subscribers are
+		 * left for the next dispatch.
+		 */
+		template <typename Event>
+		void DispatchQueued();
+
+		/**
+		 * DispatchQueued() for every event type, in the order each type was first
+		 * queued or batch subscribed to.
+		 */
+		void DispatchAll();
+
+		/**
+		 * Register @callback to be called with all of the events of type Event
+		 * being delivered by DispatchQueued(), on any entity. Emit() doesn't
+		 * call it.
+		 */
+		template <typename Event>
+		Subscription SubscribeBatch(
+			std::function<void(Span<const std::pair<Entity, Event>>)> callback);
+
 	private:
+		// stands in for the next index of the last index in the free list, so it
+		// can never be given to an entity
+		static const eid_t NO_FREE_INDEX = Entity::Id::INDEX_MASK;
+
 		/**
-		 * The current (if index is alive) or next (if index is dead) generation
-		 * for each index (incremented on index death).
+		 * One slot per entity index. The slot of an alive index holds the Id of
+		 * the entity using it. The slot of a dead index holds the generation the
+		 * index's next entity will get and, in place of its own index, the next
+		 * index of the free list. So an index is alive exactly when its slot's
+		 * index is itself and the free list needs no memory of its own.
 		 */
-		vector<gen_t> entIndexToGen;
+		vector<Entity::Id> entitySlots;
 
 		/**
-		 * LRU Queue of indexes waiting to be reused.
+		 * Ends of the FIFO list of indexes waiting to be reused, the oldest is
+		 * reused first. NO_FREE_INDEX when the list is empty.
 		 */
-		std::queue<eid_t> freeEntityIndexes;
+		eid_t freeHead = NO_FREE_INDEX;
+		eid_t freeTail = NO_FREE_INDEX;
+		size_t freeCount = 0;
 
 		/**
-		 * Once an entity index is allocated we track if that index represents
-		 * an entity that is alive (true) or if that index is waiting to be
-		 * recycled in this->freeEntityIndexes (false).
+		 * Free indexes taken out of the free list for ReserveEntity() to hand out
+		 * from the back. Refilled by FlushReservedEntities() with about as many
+		 * indexes as were reserved since the last flush.
 		 */
-		vector<bool> indexIsAlive;
+		vector<eid_t> reservableIndexes;
+
+		// Ids handed out by ReserveEntity() since the last FlushReservedEntities()
+		std::atomic<size_t> reservedCount;
 
 		ComponentManager compMgr;
 
 		/**
-		 * eventSignals[i] is the signal containing all subscribers to
-		 * one type of event where i = eventTypeToEventIndex.at(typeid(event))
+		 * eventSignals[i] is the signal containing all subscribers to one type
+		 * of event where i = eventTypeSlots[EventTypeIds::Of<Event>()].eventIndex
 		 *
 		 * the callback function type actually is the following:
 		 * template <typename Event>
-		 * signals2::signal<void(Entity, const Event &)>
+		 * EventSignal<void(Entity, const Event &)>
 		 */
-		typedef boost::signals2::signal<void(Entity, void *)> GenericSignal;
+		typedef EventSignal<void(Entity, void *)> GenericSignal;
 		vector<GenericSignal> eventSignals;
 
+		// eventIndex of a type that hasn't been subscribed to
+		static const uint32 NO_EVENT_INDEX = ~(uint32)0;
+
+		struct EventTypeSlot
+		{
+			// index of the type's signal in this->eventSignals
+			uint32 eventIndex = NO_EVENT_INDEX;
+
+			/**
+			 * Number of entities with entity specific subscribers to the type plus
+			 * one if it has subscribers for all entities. Emit() returns right
+			 * away when it is 0. Subscribers that unsubscribed are only uncounted
+			 * by the next Emit() that finds their signal empty.
+			 */
+			uint32 listeners = 0;
+
+			// true while the type has (or may have) subscribers for all entities
+			bool allEntityListeners = false;
+
+			// index of the type's signal in this->nonEntityEventSignals
+			uint32 nonEntityEventIndex = NO_EVENT_INDEX;
+
+			/**
+			 * True while the type has (or may have) subscribers to the events that
+			 * aren't associated with entities. Emit(const Event &) returns right
+			 * away when it is false.
+			 */
+			bool nonEntityListeners = false;
+		};
+
+		/**
+		 * eventTypeSlots[EventTypeIds::Of<T>()] says what listens to events of
+		 * type T. Grown as types are subscribed to.
+		 */
+		vector<EventTypeSlot> eventTypeSlots;
+
+		typedef EventSignal<void(void *)> NonEntitySignal;
+		vector<NonEntitySignal> nonEntityEventSignals;
+
+
 		/**
-		 * map the typeid(T) of a Event type, T, to the "index" of that
-		 * event type. Any time a subscriber to an event is added to
-		 * this->eventSignals, it will be added to the sub-vector at this index.
+		 * Queues of the events given to Enqueue(), eventQueues[i] holds the
+		 * events of type T where i = eventTypeToQueueIndex.at(typeid(T))
 		 */
-		GLOMERATE_MAP_TYPE<std::type_index, uint32> eventTypeToEventIndex;
+		vector<unique_ptr<BaseEventQueue>> eventQueues;
+		GLOMERATE_MAP_TYPE<std::type_index, uint32> eventTypeToQueueIndex;
 
 		/**
-		 * Same as this->eventTypeToEventIndex but for
-		 * this->nonEntityEventSignals
+		 * The signals of the subscribers to the events of one entity, one signal
+		 * per EventTypeIds::Of<T>() of the event types. Usually only a few so
+		 * they're searched linearly.
 		 */
-		GLOMERATE_MAP_TYPE<std::type_index, uint32>
-			eventTypeToNonEntityEventIndex;
+		struct EntityListeners
+		{
+			Entity::Id entity;
 
-		typedef boost::signals2::signal<void(void *)> NonEntitySignal;
-		vector<NonEntitySignal> nonEntityEventSignals;
+			// the type of a signal whose subscribers all unsubscribed is NO_EVENT_TYPE
+			vector<std::pair<size_t, GenericSignal>> signals;
+		};
+
+		static const size_t NO_EVENT_TYPE = ~(size_t)0;
+
+		/**
+		 * entityListeners[entityListenerIndex[e.Index()] - 1] holds the entity
+		 * specific subscribers of entity e, 0 when e has none. Unused entries are
+		 * kept in freeEntityListeners and reused with the memory of their signals
+		 * vector so that subscribing doesn't allocate once entities are recycled.
+		 */
+		vector<uint32> entityListenerIndex;
+		vector<EntityListeners> entityListeners;
+		vector<uint32> freeEntityListeners;
 
+		/**
+		 * Threads used by ParallelEach(), created the first time they're needed
+		 */
+		unique_ptr<WorkerPool> workers;
+		size_t workerThreadCount;
+
+		// true while ParallelEach() is running
+		bool parallelIterating = false;
 
-		// TODO-cs: use a map that recycles empty spots with some sort of pool
-		// to avoid excessive dynamic mem allocs when entities are
-		// created/destroyed
-		typedef GLOMERATE_MAP_TYPE<std::type_index, GenericSignal> SignalMap;
-		GLOMERATE_MAP_TYPE<Entity::Id, SignalMap> entityEventSignals;
+		/**
+		 * Events raised during ParallelEach(), eventStages[WorkerPool::ThreadIndex()]
+		 * holds the events of each thread.
+		 */
+		vector<EventStage> eventStages;
 
 	private:
+		/**
+		 * True if destroying an entity requires emitting an EntityDestruction event
+		 * or disconnecting entity specific subscribers.
+		 */
+		bool hasDestructionListeners() const;
+
+		/**
+		 * Mark the index of a destroyed entity as free to be recycled
+		 * and increase its generation.
+		 */
+		void freeIndex(eid_t i);
+
+		/**
+		 * Take the oldest index from the free list and return the Id of
+		 * the entity now using it.
+		 */
+		Entity::Id reuseIndex();
+
+		/**
+		 * Unlink the oldest index from the free list and return it, it stays dead.
+		 */
+		eid_t popFreeIndex();
+
+		/**
+		 * Add @count never used indexes and return the first of them.
+		 */
+		eid_t newIndexes(size_t count);
+
+		// true if an entity is using index @i
+		bool indexAlive(eid_t i) const;
+
+		/**
+		 * Throws an std::runtime_error saying that @operation isn't allowed
+		 * if ParallelEach() is running.
+		 */
+		void checkNotParallelIterating(const char *operation) const;
 		/**
 		 * Allocates storage space for subscribers for a new type of Event
-		 * and assigns that Event an index in this->eventTypeToEventIndex.
+		 * and assigns that Event an index in this->eventSignals.
 		 * Should only ever be called once when the first of this Event type
 		 * is seen.
 		 */
@@ -284,7 +666,7 @@ namespace ecs
 
 		/**
 		 * Same as registerEventType(), but for events that aren't associated
-		 * with entitites.
+		 * with entitites, which get an index in this->nonEntityEventSignals.
 		 */
 		template <typename Event>
 		void registerNonEntityEventType();
@@ -297,15 +679,123 @@ namespace ecs
 		 * because different signal call signatures have the same size.
 		 */
 		template <typename Event>
-		boost::signals2::signal<void(Entity, const Event &)> &
-		getSignal(boost::signals2::signal<void(Entity, void *)> &sig);
+		EventSignal<void(Entity, const Event &)> &
+		getSignal(EventSignal<void(Entity, void *)> &sig);
+
+		/**
+		 * Retrieves the slot of Event in this->eventTypeSlots, registering the
+		 * type if needed.
+		 */
+		template <typename Event>
+		EventTypeSlot &getOrRegisterEventType();
+
+		/**
+		 * Retrieves the signal of the subscribers to events with @eventTypeId on
+		 * @e, nullptr if there are none.
+		 */
+		GenericSignal *findEntitySignal(Entity::Id e, size_t eventTypeId);
+
+		/**
+		 * Disconnects and forgets all of the entity specific subscribers of @e.
+		 */
+		void removeEntityListeners(Entity::Id e);
+
+		/**
+		 * Forgets the signal of the subscribers to events with @eventTypeId on @e
+		 * once they all unsubscribed, and all of @e's entity specific subscribers
+		 * if it was the last of them.
+		 */
+		void removeEntitySignal(Entity::Id e, size_t eventTypeId);
+
+		/**
+		 * Stage an event raised during ParallelEach() in the calling thread's
+		 * EventStage, to be delivered by deliverStagedEvents().
+		 */
+		template <typename Event>
+		void stageEvent(StagedDelivery delivery, Entity::Id e, const Event &event);
+
+		/**
+		 * Deliver the events staged by every thread during ParallelEach() in the
+		 * order of the tasks that raised them.
+		 */
+		void deliverStagedEvents();
+
+		/**
+		 * Retrieves the queue of events of type Event, creating it if needed
+		 */
+		template <typename Event>
+		EventQueue<Event> &getEventQueue();
 
 		/**
-		 * Retrieves the signals2::signal for the Event specific to @entity.
+		 * Retrieves the signal for the Event specific to @entity.
 		 * If one does not exist then it will be created and returned.
 		 */
 		template <typename Event>
-		boost::signals2::signal<void(Entity, const Event &)> &
+		EventSignal<void(Entity, const Event &)> &
 		getOrCreateEntitySignal(Entity::Id entity);
+
+		/**
+		 * Implementation of EntitiesWith(). Iterates over @driver, which must be one
+		 * of the pools in @compMask, or over the smallest pool if it is null.
+		 */
+		EntityCollection entitiesWith(const ComponentManager::ComponentMask &compMask,
+			BaseComponentPool *driver);
+
+		/**
+		 * Implementation of Each() and ParallelEach(). Iterates over @driver, which
+		 * must be one of @pools, or over the smallest of @pools if it is null.
+		 * Matching entities are skipped unless @filter(entity) returns true.
+		 * Runs serially when @workerPool is null, otherwise @grainSize entities
+		 * per task on @workerPool.
+		 */
+		template <typename Func, typename Filter, typename ...CompTypes, size_t ...Indexes>
+		void each(Func &callback, const Filter &filter, const std::tuple<ComponentPool<CompTypes> *...> &pools,
+			const ComponentManager::ComponentMask &compMask, BaseComponentPool *driver,
+			WorkerPool *workerPool, size_t grainSize, IndexSequence<Indexes...>);
+
+		/**
+		 * Runs each() on the worker threads while rejecting structural changes.
+		 */
+		template <typename Func, typename Filter, typename ...CompTypes>
+		void parallelEach(Func &callback, const Filter &filter, const std::tuple<ComponentPool<CompTypes> *...> &pools,
+			const ComponentManager::ComponentMask &compMask, BaseComponentPool *driver,
+			size_t grainSize);
+
+		static BaseComponentPool *smallestPool(BaseComponentPool *const *pools, size_t count);
+
+		// each() filter that skips nothing
+		struct NoFilter
+		{
+			bool operator()(Entity::Id) const { return true; }
+		};
+
+		// each() filter for Changed<CompType> or, if AddedOnly, Added<CompType>
+		template <typename CompType, bool AddedOnly>
+		struct TickFilter
+		{
+			const ComponentPool<CompType> *pool;
+			uint64 since;
+			bool operator()(Entity::Id e) const;
+		};
+
+		/**
+		 * Filter the @count entities of @pool starting at @begin with FilterMasks().
+		 * Bit i of the result is set if the entity at @begin + i has every component in @compMask.
+		 */
+		uint64 matchBlock(const BaseComponentPool &pool, size_t begin, size_t count,
+			const ComponentManager::ComponentMask &compMask) const;
+
+		/**
+		 * Component of @e from @pool. If @aligned then the component is known to be
+		 * stored at @compIndex so it doesn't need to be looked up. Only counts as a
+		 * change when the callback's parameter can modify it (std::true_type).
+		 */
+		template <typename CompType>
+		static CompType &eachComponent(std::true_type, ComponentPool<CompType> *pool, bool aligned,
+			size_t compIndex, Entity::Id e);
+
+		template <typename CompType>
+		static const CompType &eachComponent(std::false_type, const ComponentPool<CompType> *pool,
+			bool aligned, size_t compIndex, Entity::Id e);
 	};
 };
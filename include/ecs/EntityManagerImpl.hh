@@ -4,6 +4,7 @@
 #include "ecs/Entity.hh"
 #include "ecs/Handle.hh"
 #include "ecs/EntityDestruction.hh"
+#include "ecs/Query.hh"
 
 // EntityManager
 namespace ecs
@@ -11,12 +12,20 @@ namespace ecs
 	template <typename CompType, typename ...T>
 	Handle<CompType> EntityManager::Assign(Entity::Id e, T... args)
 	{
-		return compMgr.Assign<CompType>(e, args...);
+		return Emplace<CompType>(e, std::move(args)...);
+	}
+
+	template <typename CompType, typename ...T>
+	Handle<CompType> EntityManager::Emplace(Entity::Id e, T&&... args)
+	{
+		checkNotParallelIterating("assign a component");
+		return compMgr.Emplace<CompType>(e, std::forward<T>(args)...);
 	}
 
 	template <typename CompType>
 	void EntityManager::Remove(Entity::Id e)
 	{
+		checkNotParallelIterating("remove a component");
 		compMgr.Remove<CompType>(e);
 	}
 
@@ -41,6 +50,7 @@ namespace ecs
 	template<typename CompType>
 	void EntityManager::RegisterComponentType()
 	{
+		checkNotParallelIterating("register a component type");
 		compMgr.RegisterComponentType<CompType>();
 	}
 
@@ -56,51 +66,179 @@ namespace ecs
 		return compMgr.SetMask<CompTypes...>(mask);
 	}
 
-	inline EntityManager::EntityManager()
+	template <typename ...CompTypes>
+	void EntityManager::RegisterComponentGroup()
+	{
+		checkNotParallelIterating("register a component group");
+		compMgr.RegisterGroup<CompTypes...>();
+	}
+
+	inline EntityManager::EntityManager() : reservedCount(0)
 	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		workerThreadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+
 		// update data structures for the NULL Entity
 		compMgr.entCompMasks.resize(1);
-		entIndexToGen.push_back(0);
 
-		// NULL entity is special because it isn't considered alive
-		// so we don't try to delete it when deleting all entities
-		indexIsAlive.push_back(false);
+		// NULL entity is never freed, all loops over alive entities start at index 1
+		entitySlots.push_back(Entity::Id(0, 0));
 	}
 
 	inline Entity EntityManager::NewEntity()
 	{
-		eid_t i;
-		gen_t gen;
-		if (freeEntityIndexes.size() >= ECS_ENTITY_RECYCLE_COUNT)
+		checkNotParallelIterating("create an entity");
+		FlushReservedEntities();
+
+		if (freeCount >= ECS_ENTITY_RECYCLE_COUNT)
 		{
-			i = freeEntityIndexes.front();
-			freeEntityIndexes.pop();
-			gen = entIndexToGen.at(i);  // incremented at Entity destruction
-			Assert(compMgr.entCompMasks[i] == ComponentManager::ComponentMask(),
-				"expected comp mask to be reset at destruction but it wasn't");
-			indexIsAlive[i] = true;
+			return Entity(this, reuseIndex());
 		}
-		else
+		return Entity(this, Entity::Id(newIndexes(1), 0));
+	}
+
+	inline vector<Entity::Id> EntityManager::NewEntities(size_t count)
+	{
+		checkNotParallelIterating("create entities");
+		FlushReservedEntities();
+
+		vector<Entity::Id> ids;
+		ids.reserve(count);
+
+		// recycle indexes under the same rule as NewEntity()
+		while (ids.size() < count && freeCount >= ECS_ENTITY_RECYCLE_COUNT)
+		{
+			ids.push_back(reuseIndex());
+		}
+
+		// and allocate the rest all at once
+		size_t newCount = count - ids.size();
+		eid_t firstIndex = newIndexes(newCount);
+		for (size_t i = 0; i < newCount; ++i)
+		{
+			ids.push_back(Entity::Id(firstIndex + i, 0));
+		}
+
+		return ids;
+	}
+
+	inline Entity::Id EntityManager::ReserveEntity()
+	{
+		size_t n = reservedCount.fetch_add(1, std::memory_order_relaxed);
+		if (n < reservableIndexes.size())
+		{
+			eid_t i = reservableIndexes[reservableIndexes.size() - 1 - n];
+			return Entity::Id(i, entitySlots[i].Generation());
+		}
+
+		// past the reservable indexes, the rest get new indexes in the same order
+		size_t i = entitySlots.size() + (n - reservableIndexes.size());
+		if (i >= NO_FREE_INDEX - 1)
+		{
+			// give the reservation back, later ones are past the limit too
+			reservedCount.fetch_sub(1, std::memory_order_relaxed);
+			throw std::runtime_error("out of entity indexes, too many entities are alive");
+		}
+		return Entity::Id(i, 0);
+	}
+
+	inline void EntityManager::FlushReservedEntities()
+	{
+		checkNotParallelIterating("flush reserved entities");
+
+		size_t reserved = reservedCount.load(std::memory_order_acquire);
+		if (reserved == 0)
+		{
+			return;
+		}
+
+		size_t recycled = std::min(reserved, reservableIndexes.size());
+		for (size_t n = 0; n < recycled; ++n)
+		{
+			eid_t i = reservableIndexes[reservableIndexes.size() - 1 - n];
+			entitySlots[i] = Entity::Id(i, entitySlots[i].Generation());
+		}
+		reservableIndexes.resize(reservableIndexes.size() - recycled);
+		newIndexes(reserved - recycled);
+		reservedCount.store(0, std::memory_order_release);
+
+		// expect as many reservations before the next flush, without taking
+		// indexes that NewEntity() wouldn't recycle yet
+		vector<eid_t> taken;
+		while (reservableIndexes.size() + taken.size() < reserved && freeCount > ECS_ENTITY_RECYCLE_COUNT)
+		{
+			taken.push_back(popFreeIndex());
+		}
+
+		// older indexes go closer to the back so they're handed out first
+		reservableIndexes.insert(reservableIndexes.begin(), taken.rbegin(), taken.rend());
+	}
+
+	inline eid_t EntityManager::popFreeIndex()
+	{
+		eid_t i = freeHead;
+		Entity::Id &slot = entitySlots[i];
+
+		freeHead = slot.Index();
+		if (freeHead == NO_FREE_INDEX)
+		{
+			freeTail = NO_FREE_INDEX;
+		}
+		freeCount--;
+
+		slot = Entity::Id(NO_FREE_INDEX, slot.Generation());
+		return i;
+	}
+
+	inline Entity::Id EntityManager::reuseIndex()
+	{
+		eid_t i = popFreeIndex();
+		Entity::Id &slot = entitySlots[i];
+
+		// generation was incremented at Entity destruction
+		slot = Entity::Id(i, slot.Generation());
+		Assert(compMgr.entCompMasks[i] == ComponentManager::ComponentMask(),
+			"expected comp mask to be reset at destruction but it wasn't");
+		return slot;
+	}
+
+	inline eid_t EntityManager::newIndexes(size_t count)
+	{
+		eid_t firstIndex = entitySlots.size();
+		if (count >= NO_FREE_INDEX - firstIndex)
 		{
-			i = entIndexToGen.size();
-			gen = 0;
-			entIndexToGen.push_back(gen);
-			indexIsAlive.push_back(true);
+			throw std::runtime_error("out of entity indexes, too many entities are alive");
+		}
 
-			// add a blank comp mask without copying one in
-			compMgr.entCompMasks.resize(compMgr.entCompMasks.size() + 1);
+		for (eid_t i = firstIndex; i < firstIndex + count; ++i)
+		{
+			entitySlots.push_back(Entity::Id(i, 0));
 		}
 
-		// all 3 of these data structures have 1 entry per Entity index
-		Assert(entIndexToGen.size() == indexIsAlive.size());
-		Assert(entIndexToGen.size() == compMgr.entCompMasks.size());
+		// add blank comp masks without copying one in
+		compMgr.entCompMasks.resize(entitySlots.size());
+		return firstIndex;
+	}
+
+	inline bool EntityManager::indexAlive(eid_t i) const
+	{
+		return entitySlots[i].Index() == i;
+	}
+
+	template <typename ...CompTypes>
+	vector<Entity::Id> EntityManager::CreateMany(size_t count, const CompTypes &... components)
+	{
+		vector<Entity::Id> ids = NewEntities(count);
+
+		int unused[] = { 0, (compMgr.AssignMany(ids.data(), ids.size(), components), 0)... };
+		(void)unused;
 
-		return Entity(this, Entity::Id(i, gen));
+		return ids;
 	}
 
 	inline void EntityManager::Destroy(Entity::Id e)
 	{
-		typedef boost::signals2::signal<void(Entity, void *)> GenericSig;
+		checkNotParallelIterating("destroy an entity");
 
 		if (!Valid(e))
 		{
@@ -110,111 +248,605 @@ namespace ecs
 			throw std::invalid_argument(ss.str());
 		}
 
-		Assert(indexIsAlive[e.Index()] == true);
-
 		// notify any subscribers of this entity's death before killing it
 		this->Emit(e, EntityDestruction());
 
 		// detach any subscribers listening for events on this entity
-		if (entityEventSignals.count(e) > 0) {
-			for (auto &kv : entityEventSignals[e]) {
-				GenericSig &signal = kv.second;
-				signal.disconnect_all_slots();
-			}
+		removeEntityListeners(e);
 
-			entityEventSignals.erase(e);
+		RemoveAllComponents(e);
+		freeIndex(e.Index());
+	}
+
+	inline void EntityManager::DestroyBatch(Span<const Entity::Id> entities)
+	{
+		checkNotParallelIterating("destroy entities");
+
+		for (Entity::Id e : entities)
+		{
+			if (!Valid(e))
+			{
+				std::stringstream ss;
+				ss << "entity " << e
+				   << " is not valid; it may have already been destroyed.";
+				throw std::invalid_argument(ss.str());
+			}
 		}
 
-		RemoveAllComponents(e);
-		entIndexToGen.at(e.Index())++;
-		freeEntityIndexes.push(e.Index());
-		indexIsAlive[e.Index()] = false;
+		bool emitEvents = hasDestructionListeners();
+		for (Entity::Id e : entities)
+		{
+			// skip entities given more than once
+			if (!Valid(e))
+			{
+				continue;
+			}
+
+			if (emitEvents)
+			{
+				Destroy(e);
+			}
+			else
+			{
+				compMgr.RemoveAll(e);
+				freeIndex(e.Index());
+			}
+		}
 	}
 
 	inline void EntityManager::DestroyAll()
 	{
-		for (eid_t i = 1; i < indexIsAlive.size(); ++i) {
-			if (indexIsAlive.at(i)) {
-				Destroy(Entity::Id(i, entIndexToGen.at(i)));
+		checkNotParallelIterating("destroy entities");
+
+		if (hasDestructionListeners() || compMgr.anyPoolLocked())
+		{
+			for (eid_t i = 1; i < entitySlots.size(); ++i) {
+				if (indexAlive(i)) {
+					Destroy(entitySlots[i]);
+				}
+			}
+			return;
+		}
+
+		// nobody needs to know about each entity so throw everything away at once
+		compMgr.clear();
+		for (eid_t i = 1; i < entitySlots.size(); ++i) {
+			if (indexAlive(i)) {
+				freeIndex(i);
 			}
 		}
 	}
 
+	inline bool EntityManager::hasDestructionListeners() const
+	{
+		if (entityListeners.size() > freeEntityListeners.size())
+		{
+			return true;
+		}
+
+		size_t typeId = EventTypeIds::Of<EntityDestruction>();
+		return typeId < eventTypeSlots.size()
+			&& eventTypeSlots[typeId].allEntityListeners
+			&& !eventSignals[eventTypeSlots[typeId].eventIndex].empty();
+	}
+
+	inline void EntityManager::freeIndex(eid_t i)
+	{
+		gen_t gen = entitySlots[i].Generation();
+		gen = (gen + 1 == Entity::Id::PLACEHOLDER_GENERATION) ? 0 : gen + 1;
+		entitySlots[i] = Entity::Id(NO_FREE_INDEX, gen);
+
+		if (freeTail == NO_FREE_INDEX)
+		{
+			freeHead = i;
+		}
+		else
+		{
+			entitySlots[freeTail] = Entity::Id(i, entitySlots[freeTail].Generation());
+		}
+		freeTail = i;
+		freeCount++;
+	}
+
 	inline bool EntityManager::Valid(Entity::Id e) const
 	{
-		return e.Generation() == entIndexToGen.at(e.Index());
+		// reserved but not yet flushed entities may be past the end of the slots
+		if (e.Index() >= entitySlots.size())
+		{
+			return false;
+		}
+
+		// a dead index's slot never equals an Id since it holds the next free index
+		return entitySlots[e.Index()] == e;
+	}
+
+	inline void EntityManager::Flush(CommandBuffer &buffer)
+	{
+		// the buffer may refer to reserved entities
+		FlushReservedEntities();
+
+		std::lock_guard<std::mutex> lock(buffer.mutex);
+
+		try
+		{
+			vector<Entity::Id> newEntities = NewEntities(buffer.newEntityCount);
+
+			// batch changes by component type so each pool is worked on at once
+			for (auto list : buffer.commandListOrder)
+			{
+				list->Apply(*this, newEntities);
+			}
+
+			for (Entity::Id e : buffer.destroyedEntities)
+			{
+				e = CommandBuffer::resolve(e, newEntities);
+				if (Valid(e))
+				{
+					Destroy(e);
+				}
+			}
+		}
+		catch (...)
+		{
+			buffer.clear();
+			throw;
+		}
+		buffer.clear();
 	}
 
 	inline void EntityManager::RemoveAllComponents(Entity::Id e)
 	{
+		checkNotParallelIterating("remove components");
 		compMgr.RemoveAll(e);
 	}
 
 	inline EntityManager::EntityCollection EntityManager::EntitiesWith(ComponentManager::ComponentMask compMask)
 	{
-		// find the smallest size component pool to iterate over
-		size_t minSize = ~0;
-		int minSizeCompIndex = -1;
+		checkNotParallelIterating("iterate over entities");
+		return entitiesWith(compMask, nullptr);
+	}
 
-		for (size_t i = 0; i < compMgr.ComponentTypeCount(); ++i)
+	template <typename ...CompTypes>
+	Query<CompTypes...> EntityManager::CreateQuery()
+	{
+		return Query<CompTypes...>(*this);
+	}
+
+	template <typename CompType>
+	SoaColumns<CompType> EntityManager::Columns()
+	{
+		static_assert(StorageTraits<CompType>::layout == ComponentLayout::StructOfArrays,
+			"Columns() is only available for components stored with the StructOfArrays layout");
+
+		if (compMgr.compIndexOf<CompType>() == ComponentManager::NO_COMP_INDEX)
 		{
-			if (!compMask.test(i))
-			{
-				continue;
-			}
+			RegisterComponentType<CompType>();
+		}
+		return SoaColumns<CompType>(*compMgr.getPool<CompType>());
+	}
+
+	inline EntityManager::EntityCollection EntityManager::entitiesWith(
+		const ComponentManager::ComponentMask &compMask, BaseComponentPool *driver)
+	{
+		// a group only stores entities that have all of its components so if one
+		// covers part of the query then only its entities need to be checked
+		ComponentManager::Group *group = compMgr.groupFor(compMask);
+		if (group != nullptr)
+		{
+			BaseComponentPool *groupPool = group->pools.front();
+			return EntityManager::EntityCollection(
+				*this,
+				compMask,
+				ComponentPoolEntityCollection(*groupPool, group->size),
+				groupPool->CreateIterateLock(),
+				// group stays packed until any of its entities change during iteration
+				compMask == group->mask ? &group->packed : nullptr
+			);
+		}
 
-			size_t compSize = compMgr.componentPools.at(i)->Size();
+		if (driver == nullptr)
+		{
+			// find the smallest size component pool to iterate over
+			size_t minSize = ~0;
+			int minSizeCompIndex = -1;
 
-			if (minSizeCompIndex == -1 || compSize < minSize)
+			for (size_t i = 0; i < compMgr.ComponentTypeCount(); ++i)
 			{
-				minSize = compSize;
-				minSizeCompIndex = i;
+				if (!compMask.test(i))
+				{
+					continue;
+				}
+
+				size_t compSize = compMgr.componentPools.at(i)->Size();
+
+				if (minSizeCompIndex == -1 || compSize < minSize)
+				{
+					minSize = compSize;
+					minSizeCompIndex = i;
+				}
 			}
-		}
 
-		auto smallestCompPool = compMgr.componentPools.at(minSizeCompIndex);
+			driver = compMgr.componentPools.at(minSizeCompIndex);
+		}
 
 		return EntityManager::EntityCollection(
 			*this,
 			compMask,
-			smallestCompPool->Entities(),
-			smallestCompPool->CreateIterateLock()
+			driver->Entities(),
+			driver->CreateIterateLock()
 		);
 	}
 
+	template <typename ...CompTypes, typename Func>
+	void EntityManager::Each(Func callback)
+	{
+		static_assert(sizeof...(CompTypes) > 0, "Each needs at least one component type");
+		checkNotParallelIterating("iterate over entities");
+
+		std::tuple<ComponentPool<CompTypes> *...> pools(compMgr.getPool<CompTypes>()...);
+		each(callback, NoFilter(), pools, compMgr.CreateMask<CompTypes...>(), nullptr, nullptr, 0,
+			typename MakeIndexSequence<sizeof...(CompTypes)>::type());
+	}
+
+	template <typename ...CompTypes, typename FilterType, typename Func>
+	void EntityManager::Each(const Changed<FilterType> &filter, Func callback)
+	{
+		static_assert(sizeof...(CompTypes) > 0, "Each needs at least one component type");
+		checkNotParallelIterating("iterate over entities");
+
+		std::tuple<ComponentPool<CompTypes> *...> pools(compMgr.getPool<CompTypes>()...);
+		TickFilter<FilterType, false> tickFilter = { compMgr.getPool<FilterType>(), filter.since };
+		each(callback, tickFilter, pools, compMgr.CreateMask<CompTypes...>(), nullptr, nullptr, 0,
+			typename MakeIndexSequence<sizeof...(CompTypes)>::type());
+	}
+
+	template <typename ...CompTypes, typename FilterType, typename Func>
+	void EntityManager::Each(const Added<FilterType> &filter, Func callback)
+	{
+		static_assert(sizeof...(CompTypes) > 0, "Each needs at least one component type");
+		checkNotParallelIterating("iterate over entities");
+
+		std::tuple<ComponentPool<CompTypes> *...> pools(compMgr.getPool<CompTypes>()...);
+		TickFilter<FilterType, true> tickFilter = { compMgr.getPool<FilterType>(), filter.since };
+		each(callback, tickFilter, pools, compMgr.CreateMask<CompTypes...>(), nullptr, nullptr, 0,
+			typename MakeIndexSequence<sizeof...(CompTypes)>::type());
+	}
+
+	inline uint64 EntityManager::ChangeTick() const
+	{
+		return compMgr.changeTick;
+	}
+
+	inline uint64 EntityManager::AdvanceChangeTick()
+	{
+		checkNotParallelIterating("advance the change tick");
+		return compMgr.changeTick++;
+	}
+
+	template <typename CompType, bool AddedOnly>
+	bool EntityManager::TickFilter<CompType, AddedOnly>::operator()(Entity::Id e) const
+	{
+		return AddedOnly ? pool->AddedSince(e, since) : pool->ChangedSince(e, since);
+	}
+
+	template <typename ...CompTypes, typename Func>
+	void EntityManager::ParallelEach(Func callback, size_t grainSize)
+	{
+		static_assert(sizeof...(CompTypes) > 0, "ParallelEach needs at least one component type");
+		checkNotParallelIterating("iterate over entities");
+
+		std::tuple<ComponentPool<CompTypes> *...> pools(compMgr.getPool<CompTypes>()...);
+		parallelEach(callback, NoFilter(), pools, compMgr.CreateMask<CompTypes...>(), nullptr, grainSize);
+	}
+
+	template <typename ...CompTypes, typename FilterType, typename Func>
+	void EntityManager::ParallelEach(const Changed<FilterType> &filter, Func callback, size_t grainSize)
+	{
+		static_assert(sizeof...(CompTypes) > 0, "ParallelEach needs at least one component type");
+		checkNotParallelIterating("iterate over entities");
+
+		std::tuple<ComponentPool<CompTypes> *...> pools(compMgr.getPool<CompTypes>()...);
+		TickFilter<FilterType, false> tickFilter = { compMgr.getPool<FilterType>(), filter.since };
+		parallelEach(callback, tickFilter, pools, compMgr.CreateMask<CompTypes...>(), nullptr, grainSize);
+	}
+
+	template <typename ...CompTypes, typename FilterType, typename Func>
+	void EntityManager::ParallelEach(const Added<FilterType> &filter, Func callback, size_t grainSize)
+	{
+		static_assert(sizeof...(CompTypes) > 0, "ParallelEach needs at least one component type");
+		checkNotParallelIterating("iterate over entities");
+
+		std::tuple<ComponentPool<CompTypes> *...> pools(compMgr.getPool<CompTypes>()...);
+		TickFilter<FilterType, true> tickFilter = { compMgr.getPool<FilterType>(), filter.since };
+		parallelEach(callback, tickFilter, pools, compMgr.CreateMask<CompTypes...>(), nullptr, grainSize);
+	}
+
+	template <typename Func, typename Filter, typename ...CompTypes>
+	void EntityManager::parallelEach(Func &callback, const Filter &filter, const std::tuple<ComponentPool<CompTypes> *...> &pools,
+		const ComponentManager::ComponentMask &compMask, BaseComponentPool *driver, size_t grainSize)
+	{
+		if (grainSize == 0)
+		{
+			throw invalid_argument("ParallelEach grainSize must be at least 1");
+		}
+
+		if (!workers)
+		{
+			workers.reset(new WorkerPool(workerThreadCount));
+		}
+
+		eventStages.resize(workers->ThreadCount() + 1);
+
+		parallelIterating = true;
+		try
+		{
+			each(callback, filter, pools, compMask, driver, workers.get(), grainSize,
+				typename MakeIndexSequence<sizeof...(CompTypes)>::type());
+		}
+		catch (...)
+		{
+			parallelIterating = false;
+			for (EventStage &stage : eventStages)
+			{
+				stage.Clear();
+			}
+			throw;
+		}
+		parallelIterating = false;
+
+		deliverStagedEvents();
+	}
+
+	inline void EntityManager::deliverStagedEvents()
+	{
+		// subscribers may start another ParallelEach() so deliver from a copy
+		vector<EventStage> stages;
+		stages.swap(eventStages);
+
+		// a thread takes its tasks in increasing order so every stage is sorted by
+		// task, deliver the lowest task next until every stage is done
+		vector<size_t> next(stages.size(), 0);
+		while (true)
+		{
+			size_t lowest = stages.size();
+			for (size_t i = 0; i < stages.size(); ++i)
+			{
+				auto &entries = stages[i].Entries();
+				if (next[i] < entries.size() && (lowest == stages.size()
+					|| entries[next[i]].task < stages[lowest].Entries()[next[lowest]].task))
+				{
+					lowest = i;
+				}
+			}
+
+			if (lowest == stages.size())
+			{
+				break;
+			}
+
+			auto &entries = stages[lowest].Entries();
+			size_t task = entries[next[lowest]].task;
+			for (; next[lowest] < entries.size() && entries[next[lowest]].task == task; ++next[lowest])
+			{
+				entries[next[lowest]].events->Deliver(*this, entries[next[lowest]].index);
+			}
+		}
+
+		for (EventStage &stage : stages)
+		{
+			stage.Clear();
+		}
+
+		// keep the memory for the next ParallelEach()
+		if (eventStages.empty())
+		{
+			eventStages.swap(stages);
+		}
+	}
+
+	inline void EntityManager::SetWorkerThreadCount(size_t count)
+	{
+		checkNotParallelIterating("change the worker thread count");
+		workers.reset();
+		workerThreadCount = count;
+	}
+
+	inline void EntityManager::checkNotParallelIterating(const char *operation) const
+	{
+		if (parallelIterating)
+		{
+			std::stringstream ss;
+			ss << "cannot " << operation << " while ParallelEach() is running";
+			throw runtime_error(ss.str());
+		}
+	}
+
+	template <typename Func, typename Filter, typename ...CompTypes, size_t ...Indexes>
+	void EntityManager::each(Func &callback, const Filter &filter, const std::tuple<ComponentPool<CompTypes> *...> &pools,
+		const ComponentManager::ComponentMask &compMask, BaseComponentPool *driver,
+		WorkerPool *workerPool, size_t grainSize, IndexSequence<Indexes...>)
+	{
+		BaseComponentPool *basePools[] = { std::get<Indexes>(pools)... };
+
+		// iterate over a group's packed components if there is one for these types,
+		// otherwise over the smallest pool
+		ComponentManager::Group *group = compMgr.groupFor(compMask);
+		size_t size;
+		if (group != nullptr)
+		{
+			driver = group->pools.front();
+			size = group->size;
+		}
+		else
+		{
+			if (driver == nullptr)
+			{
+				driver = smallestPool(basePools, sizeof...(CompTypes));
+			}
+			size = driver->Size();
+		}
+
+		bool inGroup[] = {
+			group != nullptr && std::find(group->pools.begin(), group->pools.end(),
+				basePools[Indexes]) != group->pools.end()...
+		};
+		bool exactGroup = group != nullptr && group->mask == compMask;
+
+		auto iLock = driver->CreateIterateLock();
+
+		auto eachInRange = [&](size_t begin, size_t end)
+		{
+			// find the matches of a whole block of candidates at once, then visit them
+			size_t blockStart = begin;
+			while (blockStart < end)
+			{
+				size_t count = std::min(MASK_FILTER_BLOCK, end - blockStart);
+
+				// while a group stays packed, its components are stored at the same
+				// index in every one of its pools and all of its entities match
+				uint64 matches;
+				if (group != nullptr && group->packed && exactGroup)
+				{
+					matches = count == MASK_FILTER_BLOCK ? ~(uint64)0 : ((uint64)1 << count) - 1;
+				}
+				else
+				{
+					matches = matchBlock(*driver, blockStart, count, compMask);
+				}
+
+				uint64 version = compMgr.maskVersion;
+				size_t nextBlock = blockStart + count;
+				while (matches != 0)
+				{
+					size_t i = blockStart + LowestSetBit(matches);
+					matches &= matches - 1;
+
+					Entity::Id e = driver->entities[i];
+					if (!filter(e))
+					{
+						continue;
+					}
+
+					bool packed = group != nullptr && group->packed;
+					callback(Entity(this, e), eachComponent(WritesArg<Func, Indexes + 1>(), std::get<Indexes>(pools),
+						basePools[Indexes] == driver || (packed && inGroup[Indexes]), i, e)...);
+
+					// the callback changed which entities match so filter the rest again
+					if (compMgr.maskVersion != version)
+					{
+						nextBlock = i + 1;
+						break;
+					}
+				}
+				blockStart = nextBlock;
+			}
+		};
+
+		if (workerPool == nullptr)
+		{
+			eachInRange(0, size);
+			return;
+		}
+
+		// structural changes are rejected while running in parallel
+		// so nothing can move components around until every chunk is done
+		workerPool->Run((size + grainSize - 1) / grainSize, [&](size_t chunk)
+		{
+			eachInRange(chunk * grainSize, std::min(size, (chunk + 1) * grainSize));
+		});
+	}
+
+	inline uint64 EntityManager::matchBlock(const BaseComponentPool &pool, size_t begin, size_t count,
+		const ComponentManager::ComponentMask &compMask) const
+	{
+		uint64 matches = count == MASK_FILTER_BLOCK ? ~(uint64)0 : ((uint64)1 << count) - 1;
+		uint64 masks[MASK_FILTER_BLOCK];
+
+		// only the words the query needs bits from are filtered, so a wide mask costs
+		// no more than a 64 bit one when the query's types share a word
+		for (size_t w = 0; w < ComponentMask::WORDS && matches != 0; ++w)
+		{
+			uint64 required = compMask.Word(w);
+			if (required == 0)
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				masks[i] = compMgr.entCompMasks[pool.entities[begin + i].Index()].Word(w);
+			}
+			matches &= FilterMasks(masks, count, required);
+		}
+		return matches;
+	}
+
+	inline BaseComponentPool *EntityManager::smallestPool(BaseComponentPool *const *pools, size_t count)
+	{
+		BaseComponentPool *smallest = pools[0];
+		for (size_t i = 1; i < count; ++i)
+		{
+			if (pools[i]->Size() < smallest->Size())
+			{
+				smallest = pools[i];
+			}
+		}
+		return smallest;
+	}
+
+	template <typename CompType>
+	CompType &EntityManager::eachComponent(std::true_type, ComponentPool<CompType> *pool, bool aligned,
+		size_t compIndex, Entity::Id e)
+	{
+		return aligned ? pool->At(compIndex) : *pool->Get(e);
+	}
+
+	template <typename CompType>
+	const CompType &EntityManager::eachComponent(std::false_type, const ComponentPool<CompType> *pool,
+		bool aligned, size_t compIndex, Entity::Id e)
+	{
+		return aligned ? pool->At(compIndex) : *pool->Get(e);
+	}
+
 	template <typename Event>
 	void EntityManager::registerEventType()
 	{
-		std::type_index eventType = typeid(Event);
+		size_t typeId = EventTypeIds::Of<Event>();
+		if (typeId >= eventTypeSlots.size())
+		{
+			eventTypeSlots.resize(typeId + 1);
+		}
 
-		if (eventTypeToEventIndex.count(eventType) != 0)
+		if (eventTypeSlots[typeId].eventIndex != NO_EVENT_INDEX)
 		{
 			std::stringstream ss;
-			ss << "event type " << string(eventType.name())
+			ss << "event type " << string(typeid(Event).name())
 			   << " is already registered";
 			throw std::runtime_error(ss.str());
 		}
 
-		uint32 eventIndex = eventSignals.size();
-		eventTypeToEventIndex[eventType] = eventIndex;
+		eventTypeSlots[typeId].eventIndex = eventSignals.size();
 		eventSignals.push_back({});
 	}
 
 	template <typename Event>
 	void EntityManager::registerNonEntityEventType()
 	{
-		std::type_index eventType = typeid(Event);
+		size_t typeId = EventTypeIds::Of<Event>();
+		if (typeId >= eventTypeSlots.size())
+		{
+			eventTypeSlots.resize(typeId + 1);
+		}
 
-		if (eventTypeToNonEntityEventIndex.count(eventType) != 0)
+		if (eventTypeSlots[typeId].nonEntityEventIndex != NO_EVENT_INDEX)
 		{
 			std::stringstream ss;
-			ss << "event type " << string(eventType.name())
+			ss << "event type " << string(typeid(Event).name())
 			   << " is already registered";
 			throw std::runtime_error(ss.str());
 		}
 
-		uint32 nonEntityEventIndex = nonEntityEventSignals.size();
-		eventTypeToNonEntityEventIndex[eventType] = nonEntityEventIndex;
+		eventTypeSlots[typeId].nonEntityEventIndex = nonEntityEventSignals.size();
 		nonEntityEventSignals.push_back({});
 	}
 
@@ -222,26 +854,24 @@ namespace ecs
 	Subscription EntityManager::Subscribe(
 		std::function<void(const Event &e)> callback)
 	{
-		// TODO-cs: this shares a lot of code in common with
-		// Subscribe(function<void(Entity, const Event &)>), find a way
-		// to eliminate the duplicate code.
-		std::type_index eventType = typeid(Event);
+		checkNotParallelIterating("subscribe to events");
 
-		uint32 nonEntityEventIndex;
-
-		try
-		{
-			nonEntityEventIndex = eventTypeToNonEntityEventIndex.at(eventType);
-		}
-		// Non-Entity Event never seen before, add it to the collection
-		catch (const std::out_of_range &e)
+		size_t typeId = EventTypeIds::Of<Event>();
+		if (typeId >= eventTypeSlots.size() || eventTypeSlots[typeId].nonEntityEventIndex == NO_EVENT_INDEX)
 		{
+			// Non-Entity Event never seen before, add it to the collection
 			registerNonEntityEventType<Event>();
-			nonEntityEventIndex = eventTypeToNonEntityEventIndex.at(eventType);
 		}
 
-		auto &signal = nonEntityEventSignals.at(nonEntityEventIndex);
-		boost::signals2::connection c = signal.connect(callback);
+		EventTypeSlot &slot = eventTypeSlots[typeId];
+		slot.nonEntityListeners = true;
+
+		// same reinterpret_cast as in Emit(const Event &), the stored signal
+		// only differs by the call signature of its slots
+		typedef EventSignal<void(const Event &)> TypedSignal;
+		auto &sig = nonEntityEventSignals[slot.nonEntityEventIndex];
+		TypedSignal &signal = *reinterpret_cast<TypedSignal *>(&sig);
+		EventConnection c = signal.connect(callback);
 
 		return Subscription(c);
 	}
@@ -250,24 +880,19 @@ namespace ecs
 	Subscription EntityManager::Subscribe(
 		std::function<void(Entity, const Event &)> callback)
 	{
-		typedef boost::signals2::signal<void(Entity, const Event &)> EventSignal;
-		std::type_index eventType = typeid(Event);
+		checkNotParallelIterating("subscribe to events");
 
-		uint32 eventIndex;
+		typedef EventSignal<void(Entity, const Event &)> TypedSignal;
 
-		try
+		EventTypeSlot &slot = getOrRegisterEventType<Event>();
+		if (!slot.allEntityListeners)
 		{
-			eventIndex = eventTypeToEventIndex.at(eventType);
-		}
-		// Event never seen before, add it to the collection
-		catch (const std::out_of_range &e)
-		{
-			registerEventType<Event>();
-			eventIndex = eventTypeToEventIndex.at(eventType);
+			slot.allEntityListeners = true;
+			slot.listeners++;
 		}
 
-		EventSignal &signal = getSignal<Event>(eventSignals.at(eventIndex));
-		boost::signals2::connection c = signal.connect(callback);
+		TypedSignal &signal = getSignal<Event>(eventSignals.at(slot.eventIndex));
+		EventConnection c = signal.connect(callback);
 
 		return Subscription(c);
 	}
@@ -277,54 +902,210 @@ namespace ecs
 		std::function<void(Entity, const Event &e)> callback,
 		Entity::Id entity)
 	{
+		checkNotParallelIterating("subscribe to events");
+
 		auto &eventSignal = getOrCreateEntitySignal<Event>(entity);
-		boost::signals2::connection &&c = eventSignal.connect(callback);
+		EventConnection &&c = eventSignal.connect(callback);
 
 		return Subscription(c);
 	}
 
 	template <typename Event>
-	boost::signals2::signal<void(Entity, const Event &)> &
+	EventSignal<void(Entity, const Event &)> &
 	EntityManager::getOrCreateEntitySignal(Entity::Id entity)
 	{
-		typedef boost::signals2::signal<void(Entity, void *)> GenericSig;
-		typedef boost::signals2::signal<void(Entity, const Event &)> EventSig;
+		size_t typeId = EventTypeIds::Of<Event>();
+		EventTypeSlot &slot = getOrRegisterEventType<Event>();
+
+		GenericSignal *existing = findEntitySignal(entity, typeId);
+		if (existing != nullptr)
+		{
+			return getSignal<Event>(*existing);
+		}
+
+		if (entity.Index() >= entityListenerIndex.size())
+		{
+			entityListenerIndex.resize(entity.Index() + 1, 0);
+		}
+
+		uint32 &listenerIndex = entityListenerIndex[entity.Index()];
+		if (listenerIndex == 0)
+		{
+			if (freeEntityListeners.empty())
+			{
+				entityListeners.emplace_back();
+				listenerIndex = entityListeners.size();
+			}
+			else
+			{
+				listenerIndex = freeEntityListeners.back() + 1;
+				freeEntityListeners.pop_back();
+			}
+			entityListeners[listenerIndex - 1].entity = entity;
+		}
 
-		GenericSig &genSignal = entityEventSignals[entity][typeid(Event)];
-		EventSig &eventSignal = getSignal<Event>(genSignal);
-		return eventSignal;
+		// reuse the signal of an event type whose subscribers all unsubscribed
+		auto &signals = entityListeners[listenerIndex - 1].signals;
+		slot.listeners++;
+		for (auto &signal : signals)
+		{
+			if (signal.first == NO_EVENT_TYPE)
+			{
+				signal.first = typeId;
+				return getSignal<Event>(signal.second);
+			}
+		}
+
+		signals.emplace_back(typeId, GenericSignal());
+		return getSignal<Event>(signals.back().second);
 	}
 
 	template <typename Event>
-	boost::signals2::signal<void(Entity, const Event &)> &
-	EntityManager::getSignal(boost::signals2::signal<void(Entity, void *)> &sig)
+	EntityManager::EventTypeSlot &EntityManager::getOrRegisterEventType()
+	{
+		size_t typeId = EventTypeIds::Of<Event>();
+		if (typeId >= eventTypeSlots.size() || eventTypeSlots[typeId].eventIndex == NO_EVENT_INDEX)
+		{
+			// Event never seen before, add it to the collection
+			registerEventType<Event>();
+		}
+
+		return eventTypeSlots[typeId];
+	}
+
+	inline EntityManager::GenericSignal *
+	EntityManager::findEntitySignal(Entity::Id e, size_t eventTypeId)
+	{
+		if (e.Index() >= entityListenerIndex.size() || entityListenerIndex[e.Index()] == 0)
+		{
+			return nullptr;
+		}
+
+		EntityListeners &listeners = entityListeners[entityListenerIndex[e.Index()] - 1];
+		if (listeners.entity != e)
+		{
+			return nullptr;
+		}
+
+		for (auto &signal : listeners.signals)
+		{
+			if (signal.first == eventTypeId)
+			{
+				return &signal.second;
+			}
+		}
+		return nullptr;
+	}
+
+	inline void EntityManager::removeEntityListeners(Entity::Id e)
+	{
+		if (e.Index() >= entityListenerIndex.size() || entityListenerIndex[e.Index()] == 0)
+		{
+			return;
+		}
+
+		uint32 listenerIndex = entityListenerIndex[e.Index()] - 1;
+		entityListenerIndex[e.Index()] = 0;
+		freeEntityListeners.push_back(listenerIndex);
+
+		// signals may be destroyed while one of them is being called (ex. an entity
+		// destroying itself from its own subscriber), they're built to handle that
+		auto &signals = entityListeners[listenerIndex].signals;
+		for (auto &signal : signals)
+		{
+			signal.second.disconnect_all_slots();
+			if (signal.first != NO_EVENT_TYPE)
+			{
+				eventTypeSlots[signal.first].listeners--;
+			}
+		}
+		signals.clear();
+	}
+
+	inline void EntityManager::removeEntitySignal(Entity::Id e, size_t eventTypeId)
+	{
+		auto &signals = entityListeners[entityListenerIndex[e.Index()] - 1].signals;
+		bool anyLeft = false;
+		for (auto &signal : signals)
+		{
+			if (signal.first == eventTypeId)
+			{
+				// the signal may be in the middle of being called so it isn't
+				// destroyed, only marked as unused until it's reused or the entity dies
+				signal.second.disconnect_all_slots();
+				signal.first = NO_EVENT_TYPE;
+				eventTypeSlots[eventTypeId].listeners--;
+			}
+			anyLeft = anyLeft || signal.first != NO_EVENT_TYPE;
+		}
+
+		if (!anyLeft)
+		{
+			removeEntityListeners(e);
+		}
+	}
+
+	template <typename Event>
+	EventSignal<void(Entity, const Event &)> &
+	EntityManager::getSignal(EventSignal<void(Entity, void *)> &sig)
 	{
 		// reinterpret_cast is okay here since only difference is the
 		// call signature of the stored functions, which does not affect size
-		typedef boost::signals2::signal<void(Entity, const Event &)> EventSignal;
-		return *reinterpret_cast<EventSignal *>(&sig);
+		typedef EventSignal<void(Entity, const Event &)> TypedSignal;
+		return *reinterpret_cast<TypedSignal *>(&sig);
 	}
 
 	template <typename Event>
 	void EntityManager::Emit(Entity::Id e, const Event &event)
 	{
-		typedef boost::signals2::signal<void(Entity, const Event &)> EventSignal;
-		std::type_index eventType = typeid(Event);
-		Entity entity(this, e);
+		// the common case of events nobody listens to only costs this check
+		size_t typeId = EventTypeIds::Of<Event>();
+		if (typeId >= eventTypeSlots.size() || eventTypeSlots[typeId].listeners == 0)
+		{
+			return;
+		}
 
-		// signal the generic Event subscribers
-		if (eventTypeToEventIndex.count(eventType) > 0)
+		if (parallelIterating)
 		{
-			auto eventIndex = eventTypeToEventIndex.at(eventType);
-			EventSignal &signal = getSignal<Event>(eventSignals.at(eventIndex));
-			signal(entity, event);
+			stageEvent(StagedDelivery::Emit, e, event);
+			return;
 		}
 
-		// now signal the entity-specific Event subscribers
-		if (entityEventSignals.count(e) > 0) {
-			if (entityEventSignals[e].count(eventType) > 0) {
-				auto &eventSignal = getOrCreateEntitySignal<Event>(e);
-				eventSignal(entity, event);
+		// signal the generic Event subscribers, once they've all unsubscribed
+		// stop counting them so that the check above returns again
+		Entity entity(this, e);
+		if (eventTypeSlots[typeId].allEntityListeners)
+		{
+			GenericSignal &signal = eventSignals[eventTypeSlots[typeId].eventIndex];
+			if (signal.empty())
+			{
+				eventTypeSlots[typeId].allEntityListeners = false;
+				eventTypeSlots[typeId].listeners--;
+			}
+			else
+			{
+				getSignal<Event>(signal)(entity, event);
+			}
+		}
+
+		// now signal the entity-specific Event subscribers, the generic ones
+		// may have changed eventTypeSlots
+		const EventTypeSlot &slot = eventTypeSlots[typeId];
+		if (slot.listeners > (slot.allEntityListeners ? 1u : 0u))
+		{
+			GenericSignal *entitySignal = findEntitySignal(e, typeId);
+			if (entitySignal == nullptr)
+			{
+				return;
+			}
+
+			if (entitySignal->empty())
+			{
+				removeEntitySignal(e, typeId);
+			}
+			else
+			{
+				getSignal<Event>(*entitySignal)(entity, event);
 			}
 		}
 	}
@@ -332,16 +1113,95 @@ namespace ecs
 	template <typename Event>
 	void EntityManager::Emit(const Event &event)
 	{
-		typedef boost::signals2::signal<void(const Event &)> EventSignal;
+		size_t typeId = EventTypeIds::Of<Event>();
+		if (typeId >= eventTypeSlots.size() || !eventTypeSlots[typeId].nonEntityListeners)
+		{
+			return;
+		}
+
+		if (parallelIterating)
+		{
+			stageEvent(StagedDelivery::EmitNonEntity, Entity::Id(), event);
+			return;
+		}
+
+		// stop checking the signal once all of its subscribers unsubscribed
+		NonEntitySignal &sig = nonEntityEventSignals[eventTypeSlots[typeId].nonEntityEventIndex];
+		if (sig.empty())
+		{
+			eventTypeSlots[typeId].nonEntityListeners = false;
+			return;
+		}
+
+		typedef EventSignal<void(const Event &)> TypedSignal;
+		TypedSignal &signal = *reinterpret_cast<TypedSignal *>(&sig);
+		signal(event);
+	}
+
+	template <typename Event>
+	void EntityManager::Enqueue(Entity::Id e, const Event &event)
+	{
+		if (parallelIterating)
+		{
+			stageEvent(StagedDelivery::Enqueue, e, event);
+			return;
+		}
+
+		getEventQueue<Event>().Push(Entity(this, e), event);
+	}
+
+	template <typename Event>
+	void EntityManager::stageEvent(StagedDelivery delivery, Entity::Id e, const Event &event)
+	{
+		eventStages[WorkerPool::ThreadIndex()].Push(WorkerPool::TaskIndex(), delivery, e, event);
+	}
+
+	template <typename Event>
+	void EntityManager::DispatchQueued()
+	{
+		checkNotParallelIterating("dispatch queued events");
+
+		auto queueIndex = eventTypeToQueueIndex.find(typeid(Event));
+		if (queueIndex != eventTypeToQueueIndex.end())
+		{
+			eventQueues[queueIndex->second]->Dispatch(*this);
+		}
+	}
+
+	inline void EntityManager::DispatchAll()
+	{
+		checkNotParallelIterating("dispatch queued events");
+
+		// by index since subscribers may queue events of new types
+		for (size_t i = 0; i < eventQueues.size(); ++i)
+		{
+			eventQueues[i]->Dispatch(*this);
+		}
+	}
+
+	template <typename Event>
+	Subscription EntityManager::SubscribeBatch(
+		std::function<void(Span<const std::pair<Entity, Event>>)> callback)
+	{
+		checkNotParallelIterating("subscribe to events");
+
+		return Subscription(getEventQueue<Event>().Connect(callback));
+	}
+
+	template <typename Event>
+	EventQueue<Event> &EntityManager::getEventQueue()
+	{
 		std::type_index eventType = typeid(Event);
 
-		if (eventTypeToNonEntityEventIndex.count(eventType) > 0)
+		auto queueIndex = eventTypeToQueueIndex.find(eventType);
+		if (queueIndex != eventTypeToQueueIndex.end())
 		{
-			auto eventIndex = eventTypeToNonEntityEventIndex.at(eventType);
-			auto &sig = nonEntityEventSignals.at(eventIndex);
-			EventSignal &signal = *reinterpret_cast<EventSignal *>(&sig);
-			signal(event);
+			return static_cast<EventQueue<Event> &>(*eventQueues[queueIndex->second]);
 		}
+
+		eventTypeToQueueIndex[eventType] = eventQueues.size();
+		eventQueues.emplace_back(new EventQueue<Event>());
+		return static_cast<EventQueue<Event> &>(*eventQueues.back());
 	}
 }
 
@@ -351,18 +1211,19 @@ namespace ecs
 	inline EntityManager::EntityCollection::EntityCollection(EntityManager &em,
 			const ComponentManager::ComponentMask &compMask,
 			ComponentPoolEntityCollection compEntColl,
-			unique_ptr<BaseComponentPool::IterateLock> &&iLock)
-		: em(em), compMask(compMask), compEntColl(compEntColl), iLock(std::move(iLock))
+			unique_ptr<BaseComponentPool::IterateLock> &&iLock,
+			const bool *allMatch)
+		: em(em), compMask(compMask), compEntColl(compEntColl), iLock(std::move(iLock)), allMatch(allMatch)
 	{}
 
 	inline EntityManager::EntityCollection::Iterator EntityManager::EntityCollection::begin()
 	{
-		return EntityManager::EntityCollection::Iterator(em, compMask, &compEntColl, compEntColl.begin());
+		return EntityManager::EntityCollection::Iterator(em, compMask, allMatch, &compEntColl, compEntColl.begin());
 	}
 
 	inline EntityManager::EntityCollection::Iterator EntityManager::EntityCollection::end()
 	{
-		return EntityManager::EntityCollection::Iterator(em, compMask, &compEntColl, compEntColl.end());
+		return EntityManager::EntityCollection::Iterator(em, compMask, allMatch, &compEntColl, compEntColl.end());
 	}
 }
 
@@ -371,36 +1232,65 @@ namespace ecs
 {
 	inline EntityManager::EntityCollection::Iterator::Iterator(EntityManager &em,
 			const ComponentManager::ComponentMask &compMask,
+			const bool *allMatch,
 			ComponentPoolEntityCollection *compEntColl,
 			ComponentPoolEntityCollection::Iterator compIt)
-		: em(em), compMask(compMask), compEntColl(compEntColl), compIt(compIt)
+		: em(em), compMask(compMask), allMatch(allMatch), compEntColl(compEntColl), compIt(compIt)
 	{
 		// might need to advance this iterator to the first entity that satisfies the mask
 		// since *compIt is not guarenteed to satisfy the mask right now
-		if (compIt != compEntColl->end())
+		if (compIt != compEntColl->end() && !matches(*compIt))
 		{
-			Entity::Id e = *compIt;
-			auto entCompMask = em.compMgr.entCompMasks.at(e.Index());
-			if ((entCompMask & compMask) != compMask)
-			{
-				this->operator++();
-			}
+			this->operator++();
 		}
 	}
 
 	inline EntityManager::EntityCollection::Iterator &EntityManager::EntityCollection::Iterator::operator++()
 	{
-		// find the next entity that has all the components specified by this->compMask
-		while (++compIt != compEntColl->end())
+		size_t end = compEntColl->end().Index();
+		if ((allMatch != nullptr && *allMatch) || compIt.Index() >= end)
+		{
+			++compIt;
+			return *this;
+		}
+
+		// find the next entity that has all the components specified by this->compMask,
+		// filtering the candidates a block at a time
+		while (true)
 		{
-			Entity::Id e = *compIt;
-			auto entCompMask = em.compMgr.entCompMasks.at(e.Index());
-			if ((entCompMask & compMask) == compMask)
+			if (pendingMatches != 0 && pendingVersion == em.compMgr.maskVersion)
 			{
-				break;
+				compIt.Seek(pendingBase + LowestSetBit(pendingMatches));
+				pendingMatches &= pendingMatches - 1;
+				return *this;
 			}
+
+			size_t next = compIt.Index() + 1;
+			if (next >= end)
+			{
+				compIt.Seek(end);
+				return *this;
+			}
+
+			size_t count = std::min(MASK_FILTER_BLOCK, end - next);
+			pendingMatches = em.matchBlock(compIt.Pool(), next, count, compMask);
+			pendingBase = next;
+			pendingVersion = em.compMgr.maskVersion;
+			if (pendingMatches == 0)
+			{
+				compIt.Seek(next + count - 1);
+			}
+		}
+	}
+
+	inline bool EntityManager::EntityCollection::Iterator::matches(Entity::Id e) const
+	{
+		if (allMatch != nullptr && *allMatch)
+		{
+			return true;
 		}
-		return *this;
+		auto &entCompMask = em.compMgr.entCompMasks[e.Index()];
+		return entCompMask.Contains(compMask);
 	}
 
 	inline bool EntityManager::EntityCollection::Iterator::operator==(const Iterator &other)
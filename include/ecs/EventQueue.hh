@@ -0,0 +1,51 @@
+#pragma once
+
+#include <functional>
+
+#include "ecs/Common.hh"
+#include "ecs/Entity.hh"
+#include "ecs/Signal.hh"
+
+namespace ecs
+{
+	class EntityManager;
+
+	/**
+	 * Type erased EventQueue so that EntityManager can store and dispatch the
+	 * queues of every event type together
+	 */
+	class BaseEventQueue
+	{
+	public:
+		virtual ~BaseEventQueue() {}
+
+		/**
+		 * Deliver the queued events, see EntityManager::DispatchQueued()
+		 */
+		virtual void Dispatch(EntityManager &em) = 0;
+	};
+
+	/**
+	 * Events queued with EntityManager::Enqueue() stored contiguously until
+	 * they are dispatched
+	 */
+	template <typename Event>
+	class EventQueue : public BaseEventQueue
+	{
+	public:
+		typedef std::pair<Entity, Event> QueuedEvent;
+		typedef std::function<void(Span<const QueuedEvent>)> BatchCallback;
+
+		void Push(Entity e, const Event &event);
+		EventConnection Connect(const BatchCallback &callback);
+		void Dispatch(EntityManager &em) override;
+
+	private:
+		vector<QueuedEvent> events;
+
+		// emptied buffer of the last dispatch, kept to reuse its memory
+		vector<QueuedEvent> spare;
+
+		EventSignal<void(Span<const QueuedEvent>)> batchSignal;
+	};
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+
+#include "ecs/EventQueue.hh"
+#include "ecs/EntityManager.hh"
+
+namespace ecs
+{
+	template <typename Event>
+	void EventQueue<Event>::Push(Entity e, const Event &event)
+	{
+		events.emplace_back(e, event);
+	}
+
+	template <typename Event>
+	EventConnection EventQueue<Event>::Connect(const BatchCallback &callback)
+	{
+		return batchSignal.connect(callback);
+	}
+
+	template <typename Event>
+	void EventQueue<Event>::Dispatch(EntityManager &em)
+	{
+		if (events.empty())
+		{
+			return;
+		}
+
+		// take the queued events and queue into the memory of the last dispatch,
+		// events queued by the subscribers are left for the next dispatch
+		vector<QueuedEvent> batch;
+		batch.swap(events);
+		events.swap(spare);
+
+		// drop the events of entities destroyed since they were queued
+		batch.erase(std::remove_if(batch.begin(), batch.end(),
+			[](const QueuedEvent &queued) { return !queued.first.Valid(); }),
+			batch.end());
+
+		batchSignal(Span<const QueuedEvent>(batch));
+		for (const QueuedEvent &queued : batch)
+		{
+			// a subscriber may have destroyed a later event's entity
+			if (queued.first.Valid())
+			{
+				em.Emit(queued.first.GetId(), queued.second);
+			}
+		}
+
+		batch.clear();
+		spare.swap(batch);
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ecs/Common.hh"
+#include "ecs/Entity.hh"
+
+namespace ecs
+{
+	class EntityManager;
+
+	// how a staged event was raised, and so how it is delivered
+	enum class StagedDelivery : uint8
+	{
+		Emit,
+		EmitNonEntity,
+		Enqueue
+	};
+
+	/**
+	 * Type erased StagedEvents so that an EventStage can hold every event type
+	 */
+	class BaseStagedEvents
+	{
+	public:
+		virtual ~BaseStagedEvents() {}
+
+		// pass the @i-th staged event on to @em as it was raised
+		virtual void Deliver(EntityManager &em, size_t i) = 0;
+		virtual void Clear() = 0;
+	};
+
+	template <typename Event>
+	class StagedEvents : public BaseStagedEvents
+	{
+	public:
+		// returns the index of the staged event
+		size_t Push(StagedDelivery delivery, Entity::Id e, const Event &event);
+		void Deliver(EntityManager &em, size_t i) override;
+		void Clear() override;
+
+	private:
+		struct Staged
+		{
+			StagedDelivery delivery;
+			Entity::Id entity;
+			Event event;
+		};
+
+		vector<Staged> events;
+	};
+
+	/**
+	 * The events raised by one thread during ParallelEach(). Only that thread
+	 * writes to it, so no locking is needed, and the thread that called
+	 * ParallelEach() delivers the events of every stage once all threads are
+	 * done. Every event remembers the WorkerPool task that raised it so that they
+	 * can be delivered in the order a serial Each() would have raised them.
+	 *
+	 * Memory is kept between ParallelEach() calls so staging doesn't allocate once
+	 * the stages have grown to the usual number of events.
+	 *
+	 * The stages of all threads are stored next to each other in a vector, so each
+	 * one is followed by a cache line of padding to keep threads from writing to
+	 * the same line. (alignas() isn't honored by vector's allocator before C++17)
+	 */
+	class EventStage
+	{
+	public:
+		struct Entry
+		{
+			size_t task;
+			BaseStagedEvents *events;
+			size_t index;
+		};
+
+		template <typename Event>
+		void Push(size_t task, StagedDelivery delivery, Entity::Id e, const Event &event);
+
+		// staged events in the order they were raised
+		const vector<Entry> &Entries() const;
+		void Clear();
+
+	private:
+		vector<Entry> entries;
+
+		// indexed by EventTypeIds::Of<Event>(), created as types are staged
+		vector<unique_ptr<BaseStagedEvents>> eventsByType;
+
+		static const size_t CACHE_LINE_SIZE = 64;
+		char padding[CACHE_LINE_SIZE] = {};
+	};
+}
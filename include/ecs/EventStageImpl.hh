@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ecs/EventStage.hh"
+#include "ecs/TypeIds.hh"
+#include "ecs/EntityManager.hh"
+
+namespace ecs
+{
+	template <typename Event>
+	size_t StagedEvents<Event>::Push(StagedDelivery delivery, Entity::Id e, const Event &event)
+	{
+		events.push_back(Staged { delivery, e, event });
+		return events.size() - 1;
+	}
+
+	template <typename Event>
+	void StagedEvents<Event>::Deliver(EntityManager &em, size_t i)
+	{
+		const Staged &staged = events[i];
+		switch (staged.delivery)
+		{
+			case StagedDelivery::Emit:
+				em.Emit(staged.entity, staged.event);
+				break;
+			case StagedDelivery::EmitNonEntity:
+				em.Emit(staged.event);
+				break;
+			case StagedDelivery::Enqueue:
+				em.Enqueue(staged.entity, staged.event);
+				break;
+		}
+	}
+
+	template <typename Event>
+	void StagedEvents<Event>::Clear()
+	{
+		events.clear();
+	}
+
+	template <typename Event>
+	void EventStage::Push(size_t task, StagedDelivery delivery, Entity::Id e, const Event &event)
+	{
+		size_t typeId = EventTypeIds::Of<Event>();
+		if (typeId >= eventsByType.size())
+		{
+			eventsByType.resize(typeId + 1);
+		}
+
+		if (!eventsByType[typeId])
+		{
+			eventsByType[typeId].reset(new StagedEvents<Event>());
+		}
+
+		BaseStagedEvents *events = eventsByType[typeId].get();
+		size_t index = static_cast<StagedEvents<Event> *>(events)->Push(delivery, e, event);
+		entries.push_back(Entry { task, events, index });
+	}
+
+	inline const vector<EventStage::Entry> &EventStage::Entries() const
+	{
+		return entries;
+	}
+
+	inline void EventStage::Clear()
+	{
+		for (auto &events : eventsByType)
+		{
+			if (events)
+			{
+				events->Clear();
+			}
+		}
+		entries.clear();
+	}
+}
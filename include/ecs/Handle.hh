@@ -24,6 +24,9 @@ namespace ecs
 		CompType *operator->() const;
 		bool operator!() const;
 
+		// access the component without it counting as a change for Changed<CompType> filters
+		const CompType &Read() const;
+
 	private:
 		Entity::Id eId;
 		ComponentPool<CompType> *compPool = nullptr;
@@ -42,6 +42,16 @@ namespace ecs
 		return compPool->Get(eId);
 	}
 
+	template <typename CompType>
+	const CompType &Handle<CompType>::Read() const
+	{
+		if (!compPool)
+		{
+			throw std::runtime_error("trying to dereference a null Handle!");
+		}
+		return *static_cast<const ComponentPool<CompType> *>(compPool)->Get(eId);
+	}
+
 	template <typename CompType>
 	bool Handle<CompType>::operator!() const {
 		return compPool == nullptr || eId == Entity::Id();
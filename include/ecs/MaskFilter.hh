@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ecs/Common.hh"
+
+// The SIMD version of FilterMasks() is chosen from the instruction sets the
+// compiler targets (ex. -mavx2 or -msse4.1). Define GLOMERATE_NO_SIMD to
+// always use the scalar version.
+#if !defined(GLOMERATE_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define GLOMERATE_MASK_FILTER_AVX2
+#elif !defined(GLOMERATE_NO_SIMD) && defined(__SSE4_1__)
+#include <smmintrin.h>
+#define GLOMERATE_MASK_FILTER_SSE41
+#endif
+
+namespace ecs
+{
+	// most masks FilterMasks() can test at once, one per bit of its result
+	static const size_t MASK_FILTER_BLOCK = 64;
+
+	/**
+	 * Test @count (at most MASK_FILTER_BLOCK) component masks against @required.
+	 * Bit i of the result is set if masks[i] has every bit of @required set.
+	 * There is no branch per mask so queries that reject most candidates don't
+	 * pay for mispredicted branches.
+	 */
+	uint64 FilterMasks(const uint64 *masks, size_t count, uint64 required);
+
+	// index of the lowest set bit of @bits, which must not be 0
+	size_t LowestSetBit(uint64 bits);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ecs/MaskFilter.hh"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ecs
+{
+	inline uint64 FilterMasks(const uint64 *masks, size_t count, uint64 required)
+	{
+		uint64 matches = 0;
+		size_t i = 0;
+
+#if defined(GLOMERATE_MASK_FILTER_AVX2)
+		const __m256i req = _mm256_set1_epi64x(static_cast<long long>(required));
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(masks + i));
+			__m256i eq = _mm256_cmpeq_epi64(_mm256_and_si256(m, req), req);
+			matches |= static_cast<uint64>(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) << i;
+		}
+#elif defined(GLOMERATE_MASK_FILTER_SSE41)
+		const __m128i req = _mm_set1_epi64x(static_cast<long long>(required));
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(masks + i));
+			__m128i eq = _mm_cmpeq_epi64(_mm_and_si128(m, req), req);
+			matches |= static_cast<uint64>(_mm_movemask_pd(_mm_castsi128_pd(eq))) << i;
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			matches |= static_cast<uint64>((masks[i] & required) == required) << i;
+		}
+		return matches;
+	}
+
+	inline size_t LowestSetBit(uint64 bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, bits);
+		return index;
+#else
+		return static_cast<size_t>(__builtin_ctzll(bits));
+#endif
+	}
+}
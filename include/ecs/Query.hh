@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+
+#include "ecs/Common.hh"
+#include "ecs/ComponentManager.hh"
+#include "ecs/EntityManager.hh"
+
+namespace ecs
+{
+	/**
+	 * A reusable query for the entities that have all of the given component types.
+	 *
+	 * The component mask and the storage for each component type are looked up once
+	 * when the query is created instead of every time that EntityManager::EntitiesWith(),
+	 * Each() or ParallelEach() is called, so a query should be created once (ex. when
+	 * a system is created) and kept for as long as its EntityManager:
+	 *
+	 * ```
+	 * auto movers = entMgr.CreateQuery<Position, Velocity>();
+	 *
+	 * // every frame
+	 * movers.Each([](Entity e, Position &pos, Velocity &vel)
+	 * {
+	 *      pos.x += vel.dx;
+	 * });
+	 * ```
+	 * The query also remembers which component type has the fewest components to
+	 * iterate over and only checks again once the size of any of the types changes
+	 * significantly.
+	 */
+	template <typename ...CompTypes>
+	class Query
+	{
+		static_assert(sizeof...(CompTypes) > 0, "a Query needs at least one component type");
+	public:
+		/**
+		 * Any of the component types that have not been registered yet will be registered.
+		 */
+		Query(EntityManager &em);
+
+		/**
+		 * Same as EntityManager::Each<CompTypes...>(callback)
+		 */
+		template <typename Func>
+		void Each(Func callback);
+
+		/**
+		 * Same as EntityManager::Each<CompTypes...>(filter, callback)
+		 */
+		template <typename FilterType, typename Func>
+		void Each(const Changed<FilterType> &filter, Func callback);
+
+		template <typename FilterType, typename Func>
+		void Each(const Added<FilterType> &filter, Func callback);
+
+		/**
+		 * Same as EntityManager::ParallelEach<CompTypes...>(callback, grainSize)
+		 */
+		template <typename Func>
+		void ParallelEach(Func callback, size_t grainSize = 1024);
+
+		/**
+		 * Same as EntityManager::ParallelEach<CompTypes...>(filter, callback, grainSize)
+		 */
+		template <typename FilterType, typename Func>
+		void ParallelEach(const Changed<FilterType> &filter, Func callback, size_t grainSize = 1024);
+
+		template <typename FilterType, typename Func>
+		void ParallelEach(const Added<FilterType> &filter, Func callback, size_t grainSize = 1024);
+
+		/**
+		 * Same as EntityManager::EntitiesWith<CompTypes...>()
+		 */
+		EntityManager::EntityCollection Entities();
+
+		const ComponentManager::ComponentMask &Mask() const;
+
+	private:
+		EntityManager *em;
+		ComponentManager::ComponentMask mask;
+		std::tuple<ComponentPool<CompTypes> *...> pools;
+		std::array<BaseComponentPool *, sizeof...(CompTypes)> basePools;
+
+		// the smallest pool when it was last chosen and the size of every pool at that time
+		BaseComponentPool *driver;
+		std::array<size_t, sizeof...(CompTypes)> poolSizes;
+
+		// choose the smallest pool again if any of the pools has
+		// grown or shrunk by more than half since it was chosen
+		BaseComponentPool *getDriver();
+		void chooseDriver();
+	};
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "ecs/Query.hh"
+
+namespace ecs
+{
+	template <typename ...CompTypes>
+	Query<CompTypes...>::Query(EntityManager &em) : em(&em)
+	{
+		int unused[] = { (em.compMgr.compIndexOf<CompTypes>() == ComponentManager::NO_COMP_INDEX
+			? (em.RegisterComponentType<CompTypes>(), 0) : 0)... };
+		(void)unused;
+
+		mask = em.compMgr.CreateMask<CompTypes...>();
+		pools = std::make_tuple(em.compMgr.getPool<CompTypes>()...);
+		basePools = {{ em.compMgr.getPool<CompTypes>()... }};
+
+		chooseDriver();
+	}
+
+	template <typename ...CompTypes>
+	template <typename Func>
+	void Query<CompTypes...>::Each(Func callback)
+	{
+		em->checkNotParallelIterating("iterate over entities");
+		em->each(callback, EntityManager::NoFilter(), pools, mask, getDriver(), nullptr, 0,
+			typename MakeIndexSequence<sizeof...(CompTypes)>::type());
+	}
+
+	template <typename ...CompTypes>
+	template <typename FilterType, typename Func>
+	void Query<CompTypes...>::Each(const Changed<FilterType> &filter, Func callback)
+	{
+		em->checkNotParallelIterating("iterate over entities");
+		EntityManager::TickFilter<FilterType, false> tickFilter = { em->compMgr.getPool<FilterType>(), filter.since };
+		em->each(callback, tickFilter, pools, mask, getDriver(), nullptr, 0,
+			typename MakeIndexSequence<sizeof...(CompTypes)>::type());
+	}
+
+	template <typename ...CompTypes>
+	template <typename FilterType, typename Func>
+	void Query<CompTypes...>::Each(const Added<FilterType> &filter, Func callback)
+	{
+		em->checkNotParallelIterating("iterate over entities");
+		EntityManager::TickFilter<FilterType, true> tickFilter = { em->compMgr.getPool<FilterType>(), filter.since };
+		em->each(callback, tickFilter, pools, mask, getDriver(), nullptr, 0,
+			typename MakeIndexSequence<sizeof...(CompTypes)>::type());
+	}
+
+	template <typename ...CompTypes>
+	template <typename Func>
+	void Query<CompTypes...>::ParallelEach(Func callback, size_t grainSize)
+	{
+		em->checkNotParallelIterating("iterate over entities");
+		em->parallelEach(callback, EntityManager::NoFilter(), pools, mask, getDriver(), grainSize);
+	}
+
+	template <typename ...CompTypes>
+	template <typename FilterType, typename Func>
+	void Query<CompTypes...>::ParallelEach(const Changed<FilterType> &filter, Func callback, size_t grainSize)
+	{
+		em->checkNotParallelIterating("iterate over entities");
+		EntityManager::TickFilter<FilterType, false> tickFilter = { em->compMgr.getPool<FilterType>(), filter.since };
+		em->parallelEach(callback, tickFilter, pools, mask, getDriver(), grainSize);
+	}
+
+	template <typename ...CompTypes>
+	template <typename FilterType, typename Func>
+	void Query<CompTypes...>::ParallelEach(const Added<FilterType> &filter, Func callback, size_t grainSize)
+	{
+		em->checkNotParallelIterating("iterate over entities");
+		EntityManager::TickFilter<FilterType, true> tickFilter = { em->compMgr.getPool<FilterType>(), filter.since };
+		em->parallelEach(callback, tickFilter, pools, mask, getDriver(), grainSize);
+	}
+
+	template <typename ...CompTypes>
+	EntityManager::EntityCollection Query<CompTypes...>::Entities()
+	{
+		em->checkNotParallelIterating("iterate over entities");
+		return em->entitiesWith(mask, getDriver());
+	}
+
+	template <typename ...CompTypes>
+	const ComponentManager::ComponentMask &Query<CompTypes...>::Mask() const
+	{
+		return mask;
+	}
+
+	template <typename ...CompTypes>
+	BaseComponentPool *Query<CompTypes...>::getDriver()
+	{
+		for (size_t i = 0; i < basePools.size(); ++i)
+		{
+			size_t size = basePools[i]->Size();
+			if (size > poolSizes[i] * 2 || size * 2 < poolSizes[i])
+			{
+				chooseDriver();
+				break;
+			}
+		}
+		return driver;
+	}
+
+	template <typename ...CompTypes>
+	void Query<CompTypes...>::chooseDriver()
+	{
+		driver = EntityManager::smallestPool(basePools.data(), basePools.size());
+		for (size_t i = 0; i < basePools.size(); ++i)
+		{
+			poolSizes[i] = basePools[i]->Size();
+		}
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <functional>
+#include <boost/signals2.hpp>
+
+#include "ecs/Common.hh"
+
+namespace ecs
+{
+	/**
+	 * Connection between a Signal and one of its callbacks, see Signal::connect()
+	 */
+	class SignalConnection
+	{
+	public:
+		SignalConnection();
+
+		/**
+		 * Returns true if the callback will still be called by its signal
+		 */
+		bool connected() const;
+
+		/**
+		 * Stop the callback from being called. The callback (and what it captured)
+		 * is destroyed right away unless its signal is being called, in which case
+		 * the signal destroys it once the call is done.
+		 */
+		void disconnect() const;
+	private:
+		template <typename Signature>
+		friend class Signal;
+
+		// the part of a Signal's slots that its connections need to know about
+		struct Owner
+		{
+			uint32 callDepth = 0;
+
+			// true if some slots are disconnected but still stored
+			bool removed = false;
+		};
+
+		// a connected callback, shared between the signal and the connection
+		struct Slot
+		{
+			bool active = true;
+
+			// nullptr once the signal's slots are deleted
+			Owner *owner = nullptr;
+
+			virtual ~Slot() {}
+
+			// destroy the callback
+			virtual void Release() = 0;
+		};
+
+		SignalConnection(const shared_ptr<Slot> &slot);
+
+		shared_ptr<Slot> slot;
+	};
+
+	template <typename Signature>
+	class Signal;
+
+	/**
+	 * Single threaded replacement for the subset of boost::signals2::signal
+	 * used by EntityManager, enabled with GLOMERATE_LIGHTWEIGHT_EVENTS.
+	 *
+	 * Callbacks are stored in a flat vector and called in the order they were
+	 * connected. Callbacks disconnected while the signal is being called are only
+	 * marked as such and are destroyed once no call of the signal is running, so
+	 * callbacks may connect and disconnect (or destroy the signal) while being called. Callbacks connected
+	 * during a call are first called by the next one.
+	 */
+	template <typename ...Args>
+	class Signal<void(Args...)>
+	{
+	public:
+		typedef std::function<void(Args...)> Callback;
+
+		Signal() = default;
+		Signal(Signal &&other) = default;
+		Signal &operator=(Signal &&other) = default;
+		~Signal();
+
+		SignalConnection connect(const Callback &callback);
+		void operator()(Args... args);
+
+		/**
+		 * Returns true if no callbacks are connected
+		 */
+		bool empty() const;
+		void disconnect_all_slots();
+
+	private:
+		struct Slot : public SignalConnection::Slot
+		{
+			Callback callback;
+
+			void Release() override;
+		};
+
+		/**
+		 * Kept on the heap so that the slots being called stay put even if the
+		 * Signal is moved (ex. its vector grows) or destroyed by a callback.
+		 */
+		struct Slots : public SignalConnection::Owner
+		{
+			vector<shared_ptr<Slot>> slots;
+
+			// callbacks connected during a call, added to slots afterwards
+			vector<shared_ptr<Slot>> pending;
+			bool orphaned = false;
+
+			~Slots();
+			void compact();
+		};
+
+		unique_ptr<Slots> impl;
+	};
+
+#ifdef GLOMERATE_LIGHTWEIGHT_EVENTS
+	template <typename Signature>
+	using EventSignal = Signal<Signature>;
+	typedef SignalConnection EventConnection;
+#else
+	template <typename Signature>
+	using EventSignal = boost::signals2::signal<Signature>;
+	typedef boost::signals2::connection EventConnection;
+#endif
+}
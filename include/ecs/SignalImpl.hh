@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+
+#include "ecs/Signal.hh"
+
+namespace ecs
+{
+	inline SignalConnection::SignalConnection()
+	{}
+
+	inline SignalConnection::SignalConnection(const shared_ptr<Slot> &slot)
+		: slot(slot)
+	{}
+
+	inline bool SignalConnection::connected() const
+	{
+		return slot && slot->active;
+	}
+
+	inline void SignalConnection::disconnect() const
+	{
+		if (!slot || !slot->active)
+		{
+			return;
+		}
+
+		slot->active = false;
+
+		// the callback may be the one running, so it's left to the signal
+		if (slot->owner != nullptr && slot->owner->callDepth > 0)
+		{
+			slot->owner->removed = true;
+			return;
+		}
+
+		slot->Release();
+		if (slot->owner != nullptr)
+		{
+			slot->owner->removed = true;
+		}
+	}
+
+	template <typename ...Args>
+	Signal<void(Args...)>::~Signal()
+	{
+		if (!impl)
+		{
+			return;
+		}
+
+		disconnect_all_slots();
+
+		// destroyed by one of its own callbacks, the outermost call deletes the slots
+		if (impl->callDepth > 0)
+		{
+			impl->orphaned = true;
+			impl.release();
+		}
+	}
+
+	template <typename ...Args>
+	SignalConnection Signal<void(Args...)>::connect(const Callback &callback)
+	{
+		if (!impl)
+		{
+			impl.reset(new Slots());
+		}
+
+		shared_ptr<Slot> slot = make_shared<Slot>();
+		slot->callback = callback;
+		slot->owner = impl.get();
+		SignalConnection connection(slot);
+
+		if (impl->callDepth > 0)
+		{
+			impl->pending.push_back(std::move(slot));
+			return connection;
+		}
+
+		// reuse the space of disconnected callbacks before growing
+		if (impl->slots.size() == impl->slots.capacity())
+		{
+			impl->compact();
+		}
+		impl->slots.push_back(std::move(slot));
+
+		return connection;
+	}
+
+	template <typename ...Args>
+	void Signal<void(Args...)>::operator()(Args... args)
+	{
+		if (!impl)
+		{
+			return;
+		}
+
+		// finishes the call even if a callback throws
+		struct Call
+		{
+			Slots *slots;
+
+			Call(Slots *slots) : slots(slots)
+			{
+				slots->callDepth++;
+			}
+
+			~Call()
+			{
+				if (--slots->callDepth > 0)
+				{
+					return;
+				}
+
+				if (slots->orphaned)
+				{
+					delete slots;
+				}
+				else if (slots->removed || !slots->pending.empty())
+				{
+					slots->compact();
+				}
+			}
+		};
+
+		Call call(impl.get());
+
+		// slots can't be resized by callbacks while callDepth > 0
+		for (const shared_ptr<Slot> &slot : call.slots->slots)
+		{
+			if (slot->active)
+			{
+				slot->callback(args...);
+			}
+			else
+			{
+				call.slots->removed = true;
+			}
+		}
+	}
+
+	template <typename ...Args>
+	bool Signal<void(Args...)>::empty() const
+	{
+		if (!impl)
+		{
+			return true;
+		}
+
+		for (const shared_ptr<Slot> &slot : impl->slots)
+		{
+			if (slot->active)
+			{
+				return false;
+			}
+		}
+
+		for (const shared_ptr<Slot> &slot : impl->pending)
+		{
+			if (slot->active)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template <typename ...Args>
+	void Signal<void(Args...)>::disconnect_all_slots()
+	{
+		if (!impl)
+		{
+			return;
+		}
+
+		for (const shared_ptr<Slot> &slot : impl->slots)
+		{
+			slot->active = false;
+		}
+
+		for (const shared_ptr<Slot> &slot : impl->pending)
+		{
+			slot->active = false;
+		}
+
+		impl->removed = true;
+		if (impl->callDepth == 0)
+		{
+			impl->compact();
+		}
+	}
+
+	template <typename ...Args>
+	void Signal<void(Args...)>::Slot::Release()
+	{
+		callback = nullptr;
+	}
+
+	template <typename ...Args>
+	Signal<void(Args...)>::Slots::~Slots()
+	{
+		// connections may outlive the signal, they only keep an empty slot alive
+		for (const shared_ptr<Slot> &slot : slots)
+		{
+			slot->owner = nullptr;
+			slot->Release();
+		}
+
+		for (const shared_ptr<Slot> &slot : pending)
+		{
+			slot->owner = nullptr;
+			slot->Release();
+		}
+	}
+
+	template <typename ...Args>
+	void Signal<void(Args...)>::Slots::compact()
+	{
+		auto inactive = [](const shared_ptr<Slot> &slot)
+		{
+			if (slot->active)
+			{
+				return false;
+			}
+
+			slot->owner = nullptr;
+			slot->Release();
+			return true;
+		};
+
+		slots.erase(std::remove_if(slots.begin(), slots.end(), inactive), slots.end());
+		for (shared_ptr<Slot> &slot : pending)
+		{
+			if (!inactive(slot))
+			{
+				slots.push_back(std::move(slot));
+			}
+		}
+
+		pending.clear();
+		removed = false;
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+
+#include "ecs/Common.hh"
+
+namespace ecs
+{
+	/**
+	 * Declares the fields of a component type that is stored as a struct of arrays
+	 * (see ComponentLayout::StructOfArrays).  Specialize it with a static Members()
+	 * function returning a tuple of pointers to the fields, each field then gets its
+	 * own column:
+	 *
+	 * namespace ecs
+	 * {
+	 *     template <>
+	 *     struct SoaFields<Position>
+	 *     {
+	 *         static std::tuple<float Position::*, float Position::*, float Position::*> Members()
+	 *         {
+	 *             return std::make_tuple(&Position::x, &Position::y, &Position::z);
+	 *         }
+	 *     };
+	 * }
+	 */
+	template <typename CompType>
+	struct SoaFields;
+
+	template <typename MemberPointer>
+	struct MemberPointerTraits;
+
+	template <typename Class, typename Field>
+	struct MemberPointerTraits<Field Class::*>
+	{
+		// a vector<bool> column packs its values into bits so it has no Span
+		static_assert(!std::is_same<typename std::remove_cv<Field>::type, bool>::value,
+			"bool fields can't be stored as a struct of arrays, use a uint8 instead");
+
+		typedef Field FieldType;
+	};
+
+	/**
+	 * Allocator for vectors whose data must start on an Alignment byte boundary,
+	 * ex. so that SIMD code can use aligned loads
+	 */
+	template <typename T, size_t Alignment>
+	class AlignedAllocator
+	{
+	public:
+		typedef T value_type;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef AlignedAllocator<U, Alignment> other;
+		};
+
+		AlignedAllocator() {}
+		template <typename U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+		T *allocate(size_t n);
+		void deallocate(T *p, size_t n);
+
+		template <typename U>
+		bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+		template <typename U>
+		bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+	};
+
+	/**
+	 * Component container that splits each component into its fields (declared with
+	 * SoaFields) and stores every field in its own aligned column, so loops over one
+	 * field only touch that field's memory and can be vectorized.
+	 *
+	 * Provides the vector interface ComponentPool needs except element access since
+	 * there are no CompType objects to refer to, use Column() instead.
+	 */
+	template <typename CompType>
+	class SoaArray : public NonCopyable
+	{
+	public:
+		// columns start on a boundary suitable for 256 bit SIMD loads
+		static const size_t COLUMN_ALIGNMENT = 32;
+
+		typedef decltype(SoaFields<CompType>::Members()) Members;
+		static const size_t FIELD_COUNT = std::tuple_size<Members>::value;
+
+		template <size_t Field>
+		using FieldType = typename MemberPointerTraits<
+			typename std::tuple_element<Field, Members>::type>::FieldType;
+
+		template <typename ...Args>
+		void emplace_back(Args&&... args);
+		void pop_back();
+
+		size_t size() const;
+		bool empty() const;
+		void reserve(size_t capacity);
+		void clear();
+
+		// move the fields of the element at @from over those of the element at @to
+		void Move(size_t to, size_t from);
+		void Swap(size_t a, size_t b);
+
+		// all of the values of the given field, in the same order as the elements
+		template <size_t Field>
+		Span<FieldType<Field> > Column();
+
+	private:
+		template <typename Member>
+		using ColumnOf = vector<typename MemberPointerTraits<Member>::FieldType,
+			AlignedAllocator<typename MemberPointerTraits<Member>::FieldType, COLUMN_ALIGNMENT> >;
+
+		template <typename Tuple>
+		struct ColumnsFor;
+
+		template <typename ...MemberTypes>
+		struct ColumnsFor<std::tuple<MemberTypes...> >
+		{
+			typedef std::tuple<ColumnOf<MemberTypes>...> type;
+		};
+
+		typename ColumnsFor<Members>::type columns;
+
+		template <size_t ...Fields>
+		void push(const CompType &component, IndexSequence<Fields...>);
+		template <size_t ...Fields>
+		void pop(IndexSequence<Fields...>);
+		template <size_t ...Fields>
+		void reserve(size_t capacity, IndexSequence<Fields...>);
+		template <size_t ...Fields>
+		void clear(IndexSequence<Fields...>);
+		template <size_t ...Fields>
+		void move(size_t to, size_t from, IndexSequence<Fields...>);
+		template <size_t ...Fields>
+		void swap(size_t a, size_t b, IndexSequence<Fields...>);
+	};
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <new>
+
+#include "ecs/SoaArray.hh"
+
+// AlignedAllocator
+namespace ecs
+{
+	template <typename T, size_t Alignment>
+	T *AlignedAllocator<T, Alignment>::allocate(size_t n)
+	{
+		// same as std::allocator for sizes that can't be allocated
+		if (n > (std::numeric_limits<size_t>::max() - Alignment - sizeof(void *)) / sizeof(T))
+		{
+			throw std::bad_array_new_length();
+		}
+
+		// over-allocate so the data can be aligned and the original pointer stored right before it
+		size_t bytes = n * sizeof(T) + Alignment + sizeof(void *);
+		char *raw = static_cast<char *>(::operator new(bytes));
+		uintptr_t start = reinterpret_cast<uintptr_t>(raw + sizeof(void *));
+		char *aligned = reinterpret_cast<char *>((start + Alignment - 1) & ~(uintptr_t)(Alignment - 1));
+		reinterpret_cast<void **>(aligned)[-1] = raw;
+		return reinterpret_cast<T *>(aligned);
+	}
+
+	template <typename T, size_t Alignment>
+	void AlignedAllocator<T, Alignment>::deallocate(T *p, size_t)
+	{
+		::operator delete(reinterpret_cast<void **>(p)[-1]);
+	}
+}
+
+// SoaArray
+namespace ecs
+{
+	template <typename CompType>
+	template <typename ...Args>
+	void SoaArray<CompType>::emplace_back(Args&&... args)
+	{
+		push(CompType(std::forward<Args>(args)...), typename MakeIndexSequence<FIELD_COUNT>::type());
+	}
+
+	template <typename CompType>
+	void SoaArray<CompType>::pop_back()
+	{
+		Assert(!empty(), "cannot pop_back an empty SoaArray");
+		pop(typename MakeIndexSequence<FIELD_COUNT>::type());
+	}
+
+	template <typename CompType>
+	size_t SoaArray<CompType>::size() const
+	{
+		return std::get<0>(columns).size();
+	}
+
+	template <typename CompType>
+	bool SoaArray<CompType>::empty() const
+	{
+		return size() == 0;
+	}
+
+	template <typename CompType>
+	void SoaArray<CompType>::reserve(size_t capacity)
+	{
+		reserve(capacity, typename MakeIndexSequence<FIELD_COUNT>::type());
+	}
+
+	template <typename CompType>
+	void SoaArray<CompType>::clear()
+	{
+		clear(typename MakeIndexSequence<FIELD_COUNT>::type());
+	}
+
+	template <typename CompType>
+	void SoaArray<CompType>::Move(size_t to, size_t from)
+	{
+		move(to, from, typename MakeIndexSequence<FIELD_COUNT>::type());
+	}
+
+	template <typename CompType>
+	void SoaArray<CompType>::Swap(size_t a, size_t b)
+	{
+		swap(a, b, typename MakeIndexSequence<FIELD_COUNT>::type());
+	}
+
+	template <typename CompType>
+	template <size_t Field>
+	Span<typename SoaArray<CompType>::template FieldType<Field> > SoaArray<CompType>::Column()
+	{
+		return Span<FieldType<Field> >(std::get<Field>(columns));
+	}
+
+	template <typename CompType>
+	template <size_t ...Fields>
+	void SoaArray<CompType>::push(const CompType &component, IndexSequence<Fields...>)
+	{
+		Members members = SoaFields<CompType>::Members();
+		int unused[] = { 0, (std::get<Fields>(columns).push_back(component.*std::get<Fields>(members)), 0)... };
+		(void)unused;
+	}
+
+	template <typename CompType>
+	template <size_t ...Fields>
+	void SoaArray<CompType>::pop(IndexSequence<Fields...>)
+	{
+		int unused[] = { 0, (std::get<Fields>(columns).pop_back(), 0)... };
+		(void)unused;
+	}
+
+	template <typename CompType>
+	template <size_t ...Fields>
+	void SoaArray<CompType>::reserve(size_t capacity, IndexSequence<Fields...>)
+	{
+		int unused[] = { 0, (std::get<Fields>(columns).reserve(capacity), 0)... };
+		(void)unused;
+	}
+
+	template <typename CompType>
+	template <size_t ...Fields>
+	void SoaArray<CompType>::clear(IndexSequence<Fields...>)
+	{
+		int unused[] = { 0, (std::get<Fields>(columns).clear(), 0)... };
+		(void)unused;
+	}
+
+	template <typename CompType>
+	template <size_t ...Fields>
+	void SoaArray<CompType>::move(size_t to, size_t from, IndexSequence<Fields...>)
+	{
+		int unused[] = { 0, (std::get<Fields>(columns)[to] = std::move(std::get<Fields>(columns)[from]), 0)... };
+		(void)unused;
+	}
+
+	template <typename CompType>
+	template <size_t ...Fields>
+	void SoaArray<CompType>::swap(size_t a, size_t b, IndexSequence<Fields...>)
+	{
+		int unused[] = { 0, (std::swap(std::get<Fields>(columns)[a], std::get<Fields>(columns)[b]), 0)... };
+		(void)unused;
+	}
+}
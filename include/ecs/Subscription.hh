@@ -1,6 +1,6 @@
 #pragma once
 
-#include <boost/signals2.hpp>
+#include "ecs/Signal.hh"
 
 namespace ecs {
 
@@ -10,7 +10,7 @@ namespace ecs {
 	class Subscription {
 	public:
 		Subscription();
-		Subscription(boost::signals2::connection c);
+		Subscription(EventConnection c);
 		Subscription(const Subscription &other) = default;
 
 		/**
@@ -22,12 +22,13 @@ namespace ecs {
 
 		/**
 		 * Terminates this subscription so that the registered callback will
-		 * stop being called when new events are generated. It is safe to
-		 * deallocate the associated callback after calling this function.
+		 * stop being called when new events are generated. The callback and
+		 * what it captured are destroyed right away, or if an event of its type
+		 * is being emitted, once that Emit() returns.
 		 * Always safe to call, even if the subscription is not active.
 		 */
 		void Unsubscribe() const;
 	private:
-		boost::signals2::connection connection;
+		EventConnection connection;
 	};
 }
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace ecs {
 	inline Subscription::Subscription()
 	{}
 
-	inline Subscription::Subscription(boost::signals2::connection c)
+	inline Subscription::Subscription(EventConnection c)
 		: connection(c)
 	{}
 
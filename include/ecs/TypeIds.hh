@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+#include "ecs/Common.hh"
+
+namespace ecs
+{
+	/**
+	 * Gives every type of a Family a small integer id the first time the type is
+	 * used so that a type's info can be found with a vector lookup instead of
+	 * hashing its std::type_index. Each Family counts from 0 separately.
+	 *
+	 * Ids are shared by every manager in the process and are handed out in the
+	 * order that types are first seen so they are not stable between runs.
+	 */
+	template <typename Family>
+	class TypeIds
+	{
+	public:
+		template <typename T>
+		static size_t Of()
+		{
+			static const size_t id = next();
+			return id;
+		}
+
+	private:
+		static size_t next()
+		{
+			static std::atomic<size_t> nextId(0);
+			return nextId++;
+		}
+	};
+
+	struct ComponentTypeFamily {};
+	struct EventTypeFamily {};
+
+	// ids of component types, indexes of ComponentManager's per type vectors
+	typedef TypeIds<ComponentTypeFamily> ComponentTypeIds;
+
+	// ids of event types, indexes of EntityManager::eventTypeSlots
+	typedef TypeIds<EventTypeFamily> EventTypeIds;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "ecs/Common.hh"
+
+namespace ecs
+{
+	/**
+	 * A fixed set of threads which run batches of tasks.
+	 * The thread calling Run() works on the batch as well so a pool
+	 * with 0 threads simply runs every task on the calling thread.
+	 */
+	class WorkerPool : public NonCopyable
+	{
+	public:
+		WorkerPool(size_t threadCount);
+		~WorkerPool();
+
+		/**
+		 * Call task(i) for every i in [0, taskCount) across all of the pool's
+		 * threads and block until every task has finished.
+		 *
+		 * If a task throws then the tasks that haven't started yet are skipped
+		 * and the first exception is rethrown from Run().
+		 * Tasks must not call Run() on the same pool.
+		 */
+		void Run(size_t taskCount, const std::function<void(size_t)> &task);
+
+		size_t ThreadCount() const;
+
+		/**
+		 * Called from a task, the index of the thread running it: 0 for the thread
+		 * that called Run() and i + 1 for the pool's i-th thread.
+		 */
+		static size_t ThreadIndex();
+
+		/**
+		 * Called from a task, the index i it was given.
+		 */
+		static size_t TaskIndex();
+
+	private:
+		vector<std::thread> threads;
+
+		// guards everything below except nextTask
+		std::mutex mutex;
+		std::condition_variable workAvailable;
+		std::condition_variable workDone;
+
+		// incremented by every Run() so that workers notice a new batch
+		size_t batch = 0;
+		const std::function<void(size_t)> *task = nullptr;
+		size_t taskCount = 0;
+		std::atomic<size_t> nextTask;
+
+		// number of threads that haven't finished the current batch yet
+		size_t busyThreads = 0;
+		std::exception_ptr error;
+		bool stopping = false;
+
+		void workerLoop(size_t threadIndex);
+
+		// run tasks of the current batch until there are none left
+		void runTasks();
+
+		static size_t &currentThreadIndex();
+		static size_t &currentTaskIndex();
+	};
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "ecs/WorkerPool.hh"
+
+namespace ecs
+{
+	inline WorkerPool::WorkerPool(size_t threadCount) : nextTask(0)
+	{
+		threads.reserve(threadCount);
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back(&WorkerPool::workerLoop, this, i + 1);
+		}
+	}
+
+	inline WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		workAvailable.notify_all();
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	inline void WorkerPool::Run(size_t taskCount, const std::function<void(size_t)> &task)
+	{
+		if (taskCount == 0)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			this->task = &task;
+			this->taskCount = taskCount;
+			nextTask = 0;
+			busyThreads = threads.size();
+			batch++;
+		}
+		workAvailable.notify_all();
+
+		// the calling thread may itself be a worker of another pool
+		size_t callerIndex = currentThreadIndex();
+		currentThreadIndex() = 0;
+		runTasks();
+		currentThreadIndex() = callerIndex;
+
+		std::exception_ptr taskError;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			workDone.wait(lock, [this] { return busyThreads == 0; });
+			this->task = nullptr;
+			std::swap(taskError, error);
+		}
+
+		if (taskError)
+		{
+			std::rethrow_exception(taskError);
+		}
+	}
+
+	inline size_t WorkerPool::ThreadCount() const
+	{
+		return threads.size();
+	}
+
+	inline size_t WorkerPool::ThreadIndex()
+	{
+		return currentThreadIndex();
+	}
+
+	inline size_t WorkerPool::TaskIndex()
+	{
+		return currentTaskIndex();
+	}
+
+	inline size_t &WorkerPool::currentThreadIndex()
+	{
+		static thread_local size_t index = 0;
+		return index;
+	}
+
+	inline size_t &WorkerPool::currentTaskIndex()
+	{
+		static thread_local size_t index = 0;
+		return index;
+	}
+
+	inline void WorkerPool::workerLoop(size_t threadIndex)
+	{
+		currentThreadIndex() = threadIndex;
+
+		size_t lastBatch = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			workAvailable.wait(lock, [&] { return stopping || batch != lastBatch; });
+			if (stopping)
+			{
+				return;
+			}
+			lastBatch = batch;
+
+			lock.unlock();
+			runTasks();
+			lock.lock();
+
+			if (--busyThreads == 0)
+			{
+				workDone.notify_one();
+			}
+		}
+	}
+
+	inline void WorkerPool::runTasks()
+	{
+		while (true)
+		{
+			size_t i = nextTask.fetch_add(1);
+			if (i >= taskCount)
+			{
+				return;
+			}
+
+			try
+			{
+				currentTaskIndex() = i;
+				(*task)(i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+				// skip the tasks that haven't been started
+				nextTask = taskCount;
+			}
+		}
+	}
+}
@@ -0,0 +1,215 @@
+#include <atomic>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Position
+		{
+			Position(int x, int y) : x(x), y(y) {}
+			int x;
+			int y;
+		};
+
+		struct Velocity
+		{
+			Velocity(int dx) : dx(dx) {}
+			int dx;
+		};
+	}
+}
+
+namespace ecs
+{
+	template <>
+	struct StorageTraits<test::Position> : DefaultStorageTraits
+	{
+		static constexpr bool trackChanges = true;
+	};
+}
+
+namespace test
+{
+	class EcsChangeDetection : public ::testing::Test
+	{
+	protected:
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+
+		virtual void SetUp()
+		{
+			for (int i = 0; i < 10; ++i)
+			{
+				ecs::Entity e = em.NewEntity();
+				e.Assign<Position>(i, i);
+				if (i % 2 == 0)
+				{
+					e.Assign<Velocity>(1);
+				}
+				entities.push_back(e);
+			}
+		}
+
+		std::unordered_set<ecs::Entity> changedSince(uint64 since)
+		{
+			std::unordered_set<ecs::Entity> found;
+			em.Each<Position>(ecs::Changed<Position>(since), [&](ecs::Entity e, Position &)
+			{
+				found.insert(e);
+			});
+			return found;
+		}
+	};
+
+	TEST_F(EcsChangeDetection, NewComponentsAreChanged)
+	{
+		ASSERT_EQ(10u, changedSince(0).size());
+
+		uint64 since = em.AdvanceChangeTick();
+		ASSERT_EQ(since + 1, em.ChangeTick());
+		ASSERT_EQ(0u, changedSince(since).size());
+	}
+
+	TEST_F(EcsChangeDetection, HandleAccessIsAChange)
+	{
+		uint64 since = em.AdvanceChangeTick();
+
+		entities[3].Get<Position>()->x = 100;
+		(*entities[5].Get<Position>()).y = 100;
+		ASSERT_EQ(7, entities[7].Get<Position>().Read().x);
+
+		auto changed = changedSince(since);
+		ASSERT_EQ(2u, changed.size());
+		ASSERT_EQ(1u, changed.count(entities[3]));
+		ASSERT_EQ(1u, changed.count(entities[5]));
+	}
+
+	TEST_F(EcsChangeDetection, EachIsAChange)
+	{
+		uint64 since = em.AdvanceChangeTick();
+
+		em.Each<Velocity, Position>([](ecs::Entity, Velocity &vel, Position &pos)
+		{
+			pos.x += vel.dx;
+		});
+
+		auto changed = changedSince(since);
+		ASSERT_EQ(5u, changed.size());
+		for (ecs::Entity e : changed)
+		{
+			ASSERT_TRUE(e.Has<Velocity>());
+		}
+
+		// the filtered Each() above changed them again in the tick that ended
+		since = em.AdvanceChangeTick();
+		ASSERT_EQ(0u, changedSince(since).size());
+	}
+
+	TEST_F(EcsChangeDetection, ConstEachIsNotAChange)
+	{
+		uint64 since = em.AdvanceChangeTick();
+
+		int sum = 0;
+		em.Each<Velocity, Position>([&](ecs::Entity, Velocity &vel, const Position &pos)
+		{
+			sum += pos.x * vel.dx;
+		});
+		em.Each<Position>([&](ecs::Entity, Position pos)
+		{
+			sum += pos.y;
+		});
+		ASSERT_EQ(20 + 45, sum);
+
+		ASSERT_EQ(0u, changedSince(since).size());
+	}
+
+	TEST_F(EcsChangeDetection, QueryAndParallelEachFilters)
+	{
+		uint64 since = em.AdvanceChangeTick();
+		entities[2].Get<Position>()->x = 100;
+		entities[3].Get<Position>()->x = 100;
+		ecs::Entity added = em.NewEntity();
+		added.Assign<Position>(0, 0);
+		added.Assign<Velocity>(1);
+
+		auto query = em.CreateQuery<Position, Velocity>();
+		int changed = 0;
+		query.Each(ecs::Changed<Position>(since), [&](ecs::Entity, const Position &, Velocity &) { changed++; });
+		ASSERT_EQ(2, changed);
+
+		int addedCount = 0;
+		query.Each(ecs::Added<Position>(since), [&](ecs::Entity e, const Position &, Velocity &)
+		{
+			ASSERT_EQ(added, e);
+			addedCount++;
+		});
+		ASSERT_EQ(1, addedCount);
+
+		std::atomic<int> parallelChanged(0);
+		em.ParallelEach<Position>(ecs::Changed<Position>(since), [&](ecs::Entity, const Position &)
+		{
+			parallelChanged++;
+		}, 1);
+		ASSERT_EQ(3, parallelChanged.load());
+
+		std::atomic<int> parallelAdded(0);
+		query.ParallelEach(ecs::Added<Position>(since), [&](ecs::Entity, const Position &, Velocity &)
+		{
+			parallelAdded++;
+		}, 1);
+		ASSERT_EQ(1, parallelAdded.load());
+	}
+
+	TEST_F(EcsChangeDetection, FilterOnAnotherType)
+	{
+		uint64 since = em.AdvanceChangeTick();
+		entities[2].Get<Position>()->x = 0;
+		entities[3].Get<Position>()->x = 0;
+
+		int found = 0;
+		em.Each<Velocity>(ecs::Changed<Position>(since), [&](ecs::Entity e, Velocity &)
+		{
+			ASSERT_EQ(entities[2], e);
+			found++;
+		});
+		ASSERT_EQ(1, found);
+	}
+
+	TEST_F(EcsChangeDetection, Added)
+	{
+		uint64 since = em.AdvanceChangeTick();
+		entities[0].Get<Position>()->x = 5;
+		entities[1].Remove<Position>();
+		entities[1].Assign<Position>(1, 1);
+		ecs::Entity e = em.NewEntity();
+		e.Assign<Position>(0, 0);
+
+		std::unordered_set<ecs::Entity> added;
+		em.Each<Position>(ecs::Added<Position>(since), [&](ecs::Entity e, Position &)
+		{
+			added.insert(e);
+		});
+		ASSERT_EQ(2u, added.size());
+		ASSERT_EQ(1u, added.count(entities[1]));
+		ASSERT_EQ(1u, added.count(e));
+	}
+
+	TEST_F(EcsChangeDetection, TicksFollowComponentsWhenMoved)
+	{
+		uint64 since = em.AdvanceChangeTick();
+		entities[9].Get<Position>()->x = 0;
+
+		// the last component moves into the removed one's place
+		entities[0].Destroy();
+		em.RegisterComponentGroup<Position, Velocity>();
+
+		auto changed = changedSince(since);
+		ASSERT_EQ(1u, changed.size());
+		ASSERT_EQ(1u, changed.count(entities[9]));
+	}
+}
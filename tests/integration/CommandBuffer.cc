@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Position
+		{
+			Position(int x, int y) : x(x), y(y) {}
+			int x;
+			int y;
+		};
+
+		struct Tag
+		{
+			Tag() {}
+		};
+	}
+
+	class EcsCommandBuffer : public ::testing::Test
+	{
+	protected:
+		ecs::EntityManager em;
+		ecs::CommandBuffer buffer;
+		vector<ecs::Entity> entities;
+
+		virtual void SetUp()
+		{
+			em.RegisterComponentType<Position>();
+			em.RegisterComponentType<Tag>();
+
+			for (int i = 0; i < 10; ++i)
+			{
+				ecs::Entity e = em.NewEntity();
+				e.Assign<Position>(i, i);
+				entities.push_back(e);
+			}
+		}
+	};
+
+	TEST_F(EcsCommandBuffer, NothingChangesUntilFlushed)
+	{
+		buffer.Assign<Tag>(entities[0].GetId());
+		buffer.Remove<Position>(entities[1].GetId());
+		buffer.Destroy(entities[2].GetId());
+		buffer.NewEntity();
+
+		ASSERT_FALSE(buffer.Empty());
+		ASSERT_FALSE(entities[0].Has<Tag>());
+		ASSERT_TRUE(entities[1].Has<Position>());
+		ASSERT_TRUE(entities[2].Valid());
+
+		em.Flush(buffer);
+
+		ASSERT_TRUE(buffer.Empty());
+		ASSERT_TRUE(entities[0].Has<Tag>());
+		ASSERT_FALSE(entities[1].Has<Position>());
+		ASSERT_FALSE(entities[2].Valid());
+	}
+
+	TEST_F(EcsCommandBuffer, PlaceholderEntities)
+	{
+		ecs::Entity::Id placeholder = buffer.NewEntity();
+		buffer.Assign<Position>(placeholder, 100, 200);
+		buffer.Assign<Tag>(placeholder);
+		ecs::Entity::Id destroyed = buffer.NewEntity();
+		buffer.Destroy(destroyed);
+
+		em.Flush(buffer);
+
+		int found = 0;
+		for (ecs::Entity e : em.EntitiesWith<Position, Tag>())
+		{
+			ASSERT_EQ(100, e.Get<Position>()->x);
+			ASSERT_EQ(200, e.Get<Position>()->y);
+			found++;
+		}
+		ASSERT_EQ(1, found);
+	}
+
+	TEST_F(EcsCommandBuffer, ChangesWhileIterating)
+	{
+		for (ecs::Entity e : em.EntitiesWith<Position>())
+		{
+			if (e.Get<Position>()->x % 2 == 0)
+			{
+				buffer.Destroy(e.GetId());
+			}
+			else
+			{
+				buffer.Remove<Position>(e.GetId());
+				buffer.Assign<Position>(e.GetId(), -1, -1);
+			}
+			buffer.Assign<Position>(buffer.NewEntity(), 0, 0);
+		}
+
+		em.Flush(buffer);
+
+		int found = 0;
+		for (ecs::Entity e : em.EntitiesWith<Position>())
+		{
+			found++;
+			auto position = e.Get<Position>();
+			ASSERT_TRUE(position->x == 0 || position->x == -1);
+		}
+		ASSERT_EQ(15, found);
+	}
+
+	TEST_F(EcsCommandBuffer, ChangesFromParallelEach)
+	{
+		em.SetWorkerThreadCount(3);
+		em.ParallelEach<Position>([&](ecs::Entity e, Position &position)
+		{
+			if (position.x >= 5)
+			{
+				buffer.Assign<Tag>(e.GetId());
+			}
+		}, 1);
+
+		em.Flush(buffer);
+
+		for (ecs::Entity e : entities)
+		{
+			ASSERT_EQ(e.Get<Position>()->x >= 5, e.Has<Tag>());
+		}
+	}
+
+	TEST_F(EcsCommandBuffer, DestroyingTwiceIsIgnored)
+	{
+		buffer.Destroy(entities[0].GetId());
+		buffer.Destroy(entities[0].GetId());
+		ASSERT_NO_THROW(em.Flush(buffer));
+		ASSERT_FALSE(entities[0].Valid());
+	}
+
+	TEST_F(EcsCommandBuffer, ChangesToDestroyedEntitiesAreSkipped)
+	{
+		buffer.Assign<Tag>(entities[0].GetId());
+		buffer.Remove<Position>(entities[1].GetId());
+		buffer.Assign<Tag>(entities[2].GetId());
+		entities[0].Destroy();
+		entities[1].Destroy();
+
+		// enough destroyed indexes for the free list to be used, so that
+		// entities[0]'s index belongs to another entity
+		vector<ecs::Entity::Id> ids = em.NewEntities(ECS_ENTITY_RECYCLE_COUNT);
+		em.DestroyBatch(ids);
+		ecs::Entity recycled = em.NewEntity();
+		ASSERT_EQ(entities[0].GetId().Index(), recycled.GetId().Index());
+
+		ASSERT_NO_THROW(em.Flush(buffer));
+		ASSERT_FALSE(recycled.Has<Tag>());
+		ASSERT_TRUE(entities[2].Has<Tag>());
+	}
+
+	TEST_F(EcsCommandBuffer, FailedFlushIsDiscarded)
+	{
+		buffer.Remove<Tag>(entities[0].GetId());
+		ASSERT_THROW(em.Flush(buffer), std::runtime_error);
+		ASSERT_TRUE(buffer.Empty());
+	}
+
+	TEST_F(EcsCommandBuffer, PlaceholderFromAnotherBuffer)
+	{
+		ecs::CommandBuffer other;
+		other.NewEntity();
+		buffer.Assign<Tag>(other.NewEntity());
+		ASSERT_THROW(em.Flush(buffer), std::invalid_argument);
+	}
+
+	TEST_F(EcsCommandBuffer, ClearDiscardsCommands)
+	{
+		buffer.Destroy(entities[0].GetId());
+		buffer.Assign<Tag>(buffer.NewEntity());
+		buffer.Clear();
+		ASSERT_TRUE(buffer.Empty());
+
+		em.Flush(buffer);
+		ASSERT_TRUE(entities[0].Valid());
+		for (ecs::Entity e : em.EntitiesWith<Tag>())
+		{
+			FAIL() << e << " should not have a Tag";
+		}
+	}
+}
@@ -0,0 +1,232 @@
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Position
+		{
+			Position() {}
+			Position(int x, int y) : x(x), y(y) {}
+			bool operator==(const Position &other) const { return x == other.x && y == other.y; }
+			int x;
+			int y;
+		};
+
+		struct Velocity
+		{
+			Velocity() {}
+			Velocity(int dx, int dy) : dx(dx), dy(dy) {}
+			int dx;
+			int dy;
+		};
+
+		struct Name
+		{
+			Name() {}
+			Name(string name) : name(name) {}
+			string name;
+		};
+	}
+
+	class EcsComponentGroups : public ::testing::Test
+	{
+	protected:
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+
+		virtual void SetUp()
+		{
+			em.RegisterComponentGroup<Position, Velocity>();
+
+			// every 3rd entity has both components so the group's entities
+			// are scattered throughout both component pools
+			for (int i = 0; i < 30; ++i)
+			{
+				ecs::Entity e = em.NewEntity();
+				if (i % 3 != 1)
+				{
+					e.Assign<Position>(i, i);
+				}
+				if (i % 3 != 2)
+				{
+					e.Assign<Velocity>(1, -1);
+				}
+				entities.push_back(e);
+			}
+		}
+
+		std::unordered_map<ecs::Entity, int> countMatches()
+		{
+			std::unordered_map<ecs::Entity, int> found;
+			for (ecs::Entity e : em.EntitiesWith<Position, Velocity>())
+			{
+				found[e] += 1;
+			}
+			return found;
+		}
+
+		void expectMatchesComponents()
+		{
+			auto found = countMatches();
+			size_t expected = 0;
+			for (ecs::Entity e : entities)
+			{
+				if (e.Valid() && e.Has<Position>() && e.Has<Velocity>())
+				{
+					expected++;
+					EXPECT_EQ(1, found[e]) << e << " should be found once";
+				}
+			}
+			EXPECT_EQ(expected, found.size());
+		}
+	};
+
+	TEST_F(EcsComponentGroups, IterateGroup)
+	{
+		expectMatchesComponents();
+		EXPECT_EQ(10u, countMatches().size());
+	}
+
+	TEST_F(EcsComponentGroups, GroupedComponentsKeepTheirValues)
+	{
+		for (ecs::Entity e : em.EntitiesWith<Position, Velocity>())
+		{
+			auto position = e.Get<Position>();
+			ASSERT_EQ(Position(e.Index() - 1, e.Index() - 1), *position);
+		}
+	}
+
+	TEST_F(EcsComponentGroups, GroupRegisteredAfterComponents)
+	{
+		ecs::EntityManager em2;
+		for (int i = 0; i < 10; ++i)
+		{
+			ecs::Entity e = em2.NewEntity();
+			e.Assign<Velocity>(i, i);
+			if (i % 2 == 0)
+			{
+				e.Assign<Position>(i, i);
+			}
+		}
+
+		em2.RegisterComponentGroup<Velocity, Position>();
+
+		int found = 0;
+		for (ecs::Entity e : em2.EntitiesWith<Position, Velocity>())
+		{
+			ASSERT_EQ(e.Get<Velocity>()->dx, e.Get<Position>()->x);
+			found++;
+		}
+		ASSERT_EQ(5, found);
+	}
+
+	TEST_F(EcsComponentGroups, AddAndRemoveGroupComponents)
+	{
+		entities[1].Assign<Position>(100, 100);
+		entities[0].Remove<Velocity>();
+		entities[3].Remove<Position>();
+		entities[2].Assign<Velocity>(5, 5);
+		entities[6].Destroy();
+
+		expectMatchesComponents();
+		ASSERT_EQ(Position(100, 100), *entities[1].Get<Position>());
+		ASSERT_EQ(5, entities[2].Get<Velocity>()->dx);
+	}
+
+	TEST_F(EcsComponentGroups, ReassignGroupComponent)
+	{
+		entities[0].Assign<Position>(7, 7);
+		expectMatchesComponents();
+		ASSERT_EQ(Position(7, 7), *entities[0].Get<Position>());
+	}
+
+	TEST_F(EcsComponentGroups, QueryForMoreThanGroup)
+	{
+		entities[0].Assign<Name>("a");
+		entities[1].Assign<Name>("b");
+		entities[3].Assign<Name>("c");
+
+		std::unordered_map<ecs::Entity, int> found;
+		for (ecs::Entity e : em.EntitiesWith<Position, Velocity, Name>())
+		{
+			found[e] += 1;
+		}
+
+		ASSERT_EQ(2u, found.size());
+		ASSERT_EQ(1, found[entities[0]]);
+		ASSERT_EQ(1, found[entities[3]]);
+	}
+
+	TEST_F(EcsComponentGroups, ModifyGroupWhileIterating)
+	{
+		int iterated = 0;
+		for (ecs::Entity e : em.EntitiesWith<Position, Velocity>())
+		{
+			iterated++;
+			if (e == entities[0])
+			{
+				entities[3].Destroy();
+				entities[6].Remove<Velocity>();
+				entities[1].Assign<Position>(0, 0);
+			}
+			ASSERT_TRUE(e.Has<Position>() && e.Has<Velocity>());
+		}
+
+		// entities[0] may be iterated over after the others were changed
+		ASSERT_GE(iterated, 8);
+		ASSERT_LE(iterated, 10);
+
+		// group is packed again once iteration is done
+		expectMatchesComponents();
+	}
+
+	TEST_F(EcsComponentGroups, ComponentCanOnlyBeInOneGroup)
+	{
+		ASSERT_THROW((em.RegisterComponentGroup<Name, Position>()), std::runtime_error);
+	}
+
+	TEST_F(EcsComponentGroups, EachOverGroup)
+	{
+		entities[1].Assign<Position>(100, 100);
+		entities[0].Remove<Velocity>();
+
+		std::unordered_map<ecs::Entity, int> found;
+		em.Each<Velocity, Position>([&](ecs::Entity e, Velocity &vel, Position &pos)
+		{
+			found[e] += 1;
+			ASSERT_EQ(&*e.Get<Position>(), &pos);
+			ASSERT_EQ(&*e.Get<Velocity>(), &vel);
+		});
+
+		for (ecs::Entity e : entities)
+		{
+			bool matches = e.Has<Position>() && e.Has<Velocity>();
+			EXPECT_EQ(matches ? 1 : 0, found[e]) << e;
+		}
+	}
+
+	TEST_F(EcsComponentGroups, EachModifyGroupWhileIterating)
+	{
+		int iterated = 0;
+		em.Each<Position, Velocity>([&](ecs::Entity e, Position &pos, Velocity &)
+		{
+			iterated++;
+			if (e == entities[0])
+			{
+				entities[3].Destroy();
+				entities[6].Remove<Velocity>();
+				entities[1].Assign<Position>(0, 0);
+			}
+			ASSERT_EQ(&*e.Get<Position>(), &pos);
+		});
+
+		ASSERT_GE(iterated, 8);
+		ASSERT_LE(iterated, 10);
+		expectMatchesComponents();
+	}
+}
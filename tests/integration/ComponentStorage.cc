@@ -0,0 +1,342 @@
+#include <limits>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Body
+		{
+			Body() {}
+			Body(int mass) : mass(mass) {}
+			int mass;
+			char padding[60];
+		};
+
+		// counts how many instances are alive
+		struct TrackedBody
+		{
+			static int alive;
+
+			TrackedBody(int mass) : mass(mass) { alive++; }
+			TrackedBody(const TrackedBody &other) : mass(other.mass) { alive++; }
+			TrackedBody &operator=(const TrackedBody &) = default;
+			~TrackedBody() { alive--; }
+			int mass;
+		};
+
+		int TrackedBody::alive = 0;
+
+		struct Frozen {};
+
+		struct Wanted
+		{
+			Wanted(int bounty) : bounty(bounty) {}
+			int bounty;
+		};
+
+		struct Camera
+		{
+			Camera(float zoom) : zoom(zoom) {}
+			float zoom;
+		};
+
+		struct Particle
+		{
+			Particle() {}
+			Particle(float x, float y, int life) : x(x), y(y), life(life) {}
+			float x;
+			float y;
+			int life;
+		};
+	}
+}
+
+namespace ecs
+{
+	template <>
+	struct StorageTraits<test::Body> : DefaultStorageTraits
+	{
+		static constexpr ComponentLayout layout = ComponentLayout::Chunked;
+		static constexpr size_t chunkBytes = 1024;
+	};
+
+	template <>
+	struct StorageTraits<test::TrackedBody> : DefaultStorageTraits
+	{
+		static constexpr ComponentLayout layout = ComponentLayout::Chunked;
+		static constexpr size_t chunkBytes = 256;
+	};
+
+	template <>
+	struct StorageTraits<test::Wanted> : DefaultStorageTraits
+	{
+		static constexpr StorageEngine engine = StorageEngine::Sparse;
+	};
+
+	template <>
+	struct StorageTraits<test::Camera> : DefaultStorageTraits
+	{
+		static constexpr StorageEngine engine = StorageEngine::Singleton;
+	};
+
+	template <>
+	struct StorageTraits<test::Particle> : DefaultStorageTraits
+	{
+		static constexpr ComponentLayout layout = ComponentLayout::StructOfArrays;
+	};
+
+	template <>
+	struct SoaFields<test::Particle>
+	{
+		static std::tuple<float test::Particle::*, float test::Particle::*, int test::Particle::*> Members()
+		{
+			return std::make_tuple(&test::Particle::x, &test::Particle::y, &test::Particle::life);
+		}
+	};
+}
+
+namespace test
+{
+	TEST(EcsChunkedStorage, ChunkedArrayGrowsInChunks)
+	{
+		ecs::ChunkedArray<int, 16> ints;
+		vector<int *> addresses;
+		for (int i = 0; i < 100; ++i)
+		{
+			ints.emplace_back(i);
+			addresses.push_back(&ints[i]);
+		}
+
+		ASSERT_EQ(100u, ints.size());
+		for (int i = 0; i < 100; ++i)
+		{
+			ASSERT_EQ(i, ints[i]);
+			ASSERT_EQ(addresses[i], &ints[i]);
+		}
+
+		ints.pop_back();
+		ASSERT_EQ(99u, ints.size());
+		ASSERT_THROW(ints.at(99), std::out_of_range);
+
+		ints.clear();
+		ASSERT_TRUE(ints.empty());
+	}
+
+	TEST(EcsChunkedStorage, ComponentsKeepTheirAddressWhenAdding)
+	{
+		ecs::EntityManager em;
+		ecs::Entity first = em.NewEntity();
+		Body *body = &*first.Assign<Body>(1);
+
+		for (int i = 0; i < 1000; ++i)
+		{
+			em.NewEntity().Assign<Body>(i);
+		}
+
+		ASSERT_EQ(body, &*first.Get<Body>());
+		ASSERT_EQ(1, body->mass);
+	}
+
+	TEST(EcsChunkedStorage, AddRemoveAndIterate)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 100; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			entities.back().Assign<Body>(i);
+		}
+
+		for (int i = 0; i < 100; i += 3)
+		{
+			entities[i].Remove<Body>();
+		}
+
+		std::unordered_map<ecs::Entity, int> found;
+		em.Each<Body>([&](ecs::Entity e, Body &body)
+		{
+			found[e] += 1;
+			ASSERT_EQ(&*e.Get<Body>(), &body);
+		});
+
+		for (int i = 0; i < 100; ++i)
+		{
+			bool removed = i % 3 == 0;
+			ASSERT_EQ(removed ? 0 : 1, found[entities[i]]) << i;
+			if (!removed)
+			{
+				ASSERT_EQ(i, entities[i].Get<Body>()->mass);
+			}
+		}
+	}
+
+	TEST(EcsChunkedStorage, ComponentsAreDestroyed)
+	{
+		{
+			ecs::EntityManager em;
+			vector<ecs::Entity> entities;
+			for (int i = 0; i < 100; ++i)
+			{
+				entities.push_back(em.NewEntity());
+				entities.back().Assign<TrackedBody>(i);
+			}
+			entities[0].Remove<TrackedBody>();
+			entities[50].Destroy();
+			ASSERT_EQ(98, TrackedBody::alive);
+
+			em.DestroyAll();
+			ASSERT_EQ(0, TrackedBody::alive);
+
+			em.NewEntity().Assign<TrackedBody>(1);
+		}
+		ASSERT_EQ(0, TrackedBody::alive);
+	}
+
+	TEST(EcsStorageEngines, EmptyTypesAreTags)
+	{
+		static_assert(ecs::StorageTraits<Frozen>::engine == ecs::StorageEngine::Tag,
+			"empty types should default to the Tag engine");
+
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 10; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			if (i % 2 == 0)
+			{
+				entities.back().Assign<Frozen>();
+			}
+		}
+		entities[4].Remove<Frozen>();
+		entities[6].Destroy();
+
+		int found = 0;
+		for (ecs::Entity e : em.EntitiesWith<Frozen>())
+		{
+			ASSERT_TRUE(e == entities[0] || e == entities[2] || e == entities[8]) << e;
+			ASSERT_TRUE(e.Has<Frozen>());
+			found++;
+		}
+		ASSERT_EQ(3, found);
+		ASSERT_FALSE(entities[4].Has<Frozen>());
+	}
+
+	TEST(EcsStorageEngines, SparseComponents)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities = { em.NewEntity() };
+		for (int i = 1; i < 10000; ++i)
+		{
+			ecs::Entity e = em.NewEntity();
+			if (i % 1000 == 0)
+			{
+				e.Assign<Wanted>(i);
+				entities.push_back(e);
+			}
+		}
+		entities[3].Remove<Wanted>();
+
+		std::unordered_map<ecs::Entity, int> found;
+		em.Each<Wanted>([&](ecs::Entity e, Wanted &wanted)
+		{
+			found[e] = wanted.bounty;
+		});
+
+		ASSERT_EQ(8u, found.size());
+		ASSERT_EQ(0u, found.count(entities[3]));
+		ASSERT_EQ(9000, found[entities[9]]);
+		ASSERT_EQ(9000, entities[9].Get<Wanted>()->bounty);
+		ASSERT_FALSE(entities[0].Has<Wanted>());
+	}
+
+	TEST(EcsStorageEngines, SingletonComponent)
+	{
+		ecs::EntityManager em;
+		ecs::Entity e1 = em.NewEntity();
+		ecs::Entity e2 = em.NewEntity();
+
+		e1.Assign<Camera>(1.f);
+		e1.Assign<Camera>(2.f);
+		ASSERT_EQ(2.f, e1.Get<Camera>()->zoom);
+
+		ASSERT_THROW(e2.Assign<Camera>(3.f), std::runtime_error);
+		ASSERT_FALSE(e2.Has<Camera>());
+
+		e1.Destroy();
+		e2.Assign<Camera>(3.f);
+		ASSERT_EQ(3.f, e2.Get<Camera>()->zoom);
+	}
+
+	TEST(EcsSoaStorage, ColumnsHoldEachField)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 20; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			entities.back().Assign<Particle>(i, -i, i * 10);
+		}
+		entities[0].Remove<Particle>();
+		entities[7].Destroy();
+		entities[3].Assign<Particle>(100.f, -100.f, 1000);
+
+		auto particles = em.Columns<Particle>();
+		ecs::Span<float> xs = particles.Column<0>();
+		ecs::Span<float> ys = particles.Column<1>();
+		ecs::Span<int> lives = particles.Column<2>();
+		ecs::Span<const ecs::Entity::Id> ids = particles.Entities();
+
+		ASSERT_EQ(18u, particles.Size());
+		ASSERT_EQ(18u, xs.Size());
+		ASSERT_EQ(18u, lives.Size());
+		ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(xs.Data()) % 32);
+		ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(lives.Data()) % 32);
+
+		for (size_t row = 0; row < particles.Size(); ++row)
+		{
+			ecs::Entity e(&em, ids[row]);
+			ASSERT_EQ(row, particles.IndexOf(e.GetId()));
+			int i = e == entities[3] ? 100 : e.Index() - 1;
+			ASSERT_EQ(i, xs[row]);
+			ASSERT_EQ(-i, ys[row]);
+			ASSERT_EQ(i * 10, lives[row]);
+		}
+
+		ASSERT_THROW(particles.IndexOf(entities[0].GetId()), std::runtime_error);
+	}
+
+	TEST(EcsSoaStorage, IterateEntitiesWhileRemoving)
+	{
+		ecs::EntityManager em;
+		for (int i = 0; i < 10; ++i)
+		{
+			em.NewEntity().Assign<Particle>(0.f, 0.f, i);
+		}
+
+		auto particles = em.Columns<Particle>();
+		for (ecs::Entity e : em.EntitiesWith<Particle>())
+		{
+			if (particles.Column<2>()[particles.IndexOf(e.GetId())] % 2 == 0)
+			{
+				e.Remove<Particle>();
+			}
+		}
+
+		ASSERT_EQ(5u, particles.Size());
+		for (int life : particles.Column<2>())
+		{
+			ASSERT_EQ(1, life % 2);
+		}
+	}
+
+	TEST(EcsSoaStorage, AllocatingTooMuchThrows)
+	{
+		ecs::AlignedAllocator<int, 32> allocator;
+		ASSERT_THROW(allocator.allocate(std::numeric_limits<size_t>::max() / 2), std::bad_array_new_length);
+	}
+}
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <unordered_map>
 #include <stdexcept>
 
@@ -156,6 +158,29 @@ namespace test
 		ExpectPositionEntitiesFound();
 	}
 
+	TEST_F(EcsBasicIterateWithComponents, EachIteration)
+	{
+		em.Each<Eater, Position>([&](ecs::Entity ent, Eater &eater, Position &position)
+		{
+			EXPECT_EQ(&*ent.Get<Eater>(), &eater);
+			EXPECT_EQ(&*ent.Get<Position>(), &position);
+			entsFound[ent] = true;
+		});
+
+		EXPECT_TRUE(entsFound.count(ePosEat) == 1 && entsFound[ePosEat] == true);
+		EXPECT_EQ(1u, entsFound.size()) << "should have only found one entity";
+	}
+
+	TEST_F(EcsBasicIterateWithComponents, EachSingleComponent)
+	{
+		em.Each<Position>([&](ecs::Entity ent, Position &)
+		{
+			entsFound[ent] = true;
+		});
+
+		ExpectPositionEntitiesFound();
+	}
+
 	/**
 	 * This is a test for the fix in commit ea35fb59156261ff16f9993dd5c40410aefd335e
 	 * The bug was that when iterating over multiple component types the
@@ -329,6 +354,146 @@ namespace test
 			" we got to it during iteration";
 	}
 
+	TEST(EcsBugFix, RemoveLastComponentsWhileIterating)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 6; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			entities.back().Assign<Position>(i, i);
+		}
+
+		// the last component is soft removed after one before it so it must not be
+		// moved into the earlier one's place when the removals are finally done
+		for (ecs::Entity e : em.EntitiesWith<Position>())
+		{
+			if (e == entities[0])
+			{
+				entities[1].Remove<Position>();
+				entities[5].Remove<Position>();
+			}
+		}
+		entities.push_back(em.NewEntity());
+		entities.back().Assign<Position>(6, 6);
+
+		for (int i = 0; i < 7; ++i)
+		{
+			bool removed = i == 1 || i == 5;
+			ASSERT_EQ(!removed, entities[i].Has<Position>()) << i;
+			if (!removed)
+			{
+				ASSERT_EQ(Position(i, i), *entities[i].Get<Position>());
+			}
+		}
+
+		std::unordered_map<ecs::Entity, int> found;
+		for (ecs::Entity e : em.EntitiesWith<Position>())
+		{
+			found[e] += 1;
+		}
+		ASSERT_EQ(5u, found.size());
+		ASSERT_EQ(0u, found.count(entities[1]));
+		ASSERT_EQ(0u, found.count(entities[5]));
+	}
+
+	namespace
+	{
+		// counts how many instances are alive
+		struct Tracked
+		{
+			static int alive;
+
+			Tracked() { alive++; }
+			Tracked(const Tracked &) { alive++; }
+			Tracked &operator=(const Tracked &) = default;
+			~Tracked() { alive--; }
+		};
+
+		int Tracked::alive = 0;
+	}
+
+	TEST(EcsBasic, RemovedComponentsAreDestroyed)
+	{
+		{
+			ecs::EntityManager em;
+			vector<ecs::Entity> entities;
+			for (int i = 0; i < 10; ++i)
+			{
+				entities.push_back(em.NewEntity());
+				entities.back().Assign<Tracked>();
+			}
+			ASSERT_EQ(10, Tracked::alive);
+
+			entities[0].Remove<Tracked>();
+			entities[1].Destroy();
+			entities[2].Assign<Tracked>();
+			ASSERT_EQ(8, Tracked::alive);
+
+			for (ecs::Entity e : em.EntitiesWith<Tracked>())
+			{
+				if (e == entities[2])
+				{
+					entities[3].Destroy();
+					entities[9].Remove<Tracked>();
+				}
+			}
+			ASSERT_EQ(6, Tracked::alive);
+		}
+		ASSERT_EQ(0, Tracked::alive);
+	}
+
+	// entities are filtered in blocks so changes made while iterating must
+	// still be seen by the entities of the block that haven't been visited yet
+	TEST(EcsBasic, ChangeLaterEntitiesOfBlockWhileIterating)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 200; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			if (i != 50 && i != 60)
+			{
+				entities.back().Assign<Position>(i, i);
+			}
+			if (i % 10 == 0)
+			{
+				entities.back().Assign<Eater>();
+			}
+		}
+
+		// the Eater pool is the smaller one so its entities are the candidates
+		std::unordered_map<ecs::Entity, int> found;
+		em.Each<Position, Eater>([&](ecs::Entity e, Position &, Eater &)
+		{
+			found[e] += 1;
+			if (e == entities[0])
+			{
+				entities[50].Assign<Position>(50, 50);
+				entities[30].Remove<Position>();
+			}
+		});
+
+		ASSERT_EQ(18u, found.size());
+		ASSERT_EQ(1, found[entities[50]]);
+		ASSERT_EQ(0u, found.count(entities[30]));
+
+		found.clear();
+		for (ecs::Entity e : em.EntitiesWith<Position, Eater>())
+		{
+			found[e] += 1;
+			if (e == entities[0])
+			{
+				entities[60].Assign<Position>(60, 60);
+				entities[40].Remove<Position>();
+			}
+		}
+
+		ASSERT_EQ(18u, found.size());
+		ASSERT_EQ(1, found[entities[60]]);
+		ASSERT_EQ(0u, found.count(entities[40]));
+	}
+
 	TEST(EcsBasic, RegisterComponentPreventsExceptions)
 	{
 		ecs::EntityManager em;
@@ -356,6 +521,82 @@ namespace test
 		);
 	}
 
+	template <size_t N>
+	struct Filler
+	{
+		int value;
+	};
+
+	template <size_t ...Ns>
+	void registerFillerTypes(ecs::EntityManager &em, ecs::IndexSequence<Ns...>)
+	{
+		int unused[] = { (em.RegisterComponentType<Filler<Ns> >(), 0)... };
+		(void)unused;
+	}
+
+	TEST(EcsBasic, QueryComponentTypesInDifferentMaskWords)
+	{
+		const size_t maxTypes = ecs::ComponentMask::BITS;
+		ecs::EntityManager em;
+
+		// Filler<0> gets the first mask bit while Position and Eater get the last two
+		registerFillerTypes(em, ecs::MakeIndexSequence<maxTypes - 2>::type());
+		em.RegisterComponentType<Position>();
+		em.RegisterComponentType<Eater>();
+		ASSERT_THROW(em.RegisterComponentType<Filler<maxTypes> >(), std::runtime_error);
+
+		for (int i = 0; i < 200; ++i)
+		{
+			ecs::Entity e = em.NewEntity();
+			e.Assign<Position>(i, i);
+			if (i % 2 == 0)
+			{
+				e.Assign<Filler<0> >();
+			}
+			if (i % 3 == 0)
+			{
+				e.Assign<Eater>();
+			}
+		}
+
+		int found = 0;
+		for (ecs::Entity e : em.EntitiesWith<Filler<0>, Position, Eater>())
+		{
+			ASSERT_EQ(0, e.Get<Position>()->x % 6);
+			found++;
+		}
+		ASSERT_EQ(34, found);
+
+		found = 0;
+		em.Each<Eater, Position>([&](ecs::Entity, Eater &, Position &position)
+		{
+			ASSERT_EQ(0, position.x % 3);
+			found++;
+		});
+		ASSERT_EQ(67, found);
+	}
+
+	TEST(EcsBasic, ManagersRegisterComponentTypesInDifferentOrders)
+	{
+		ecs::EntityManager em1;
+		ecs::EntityManager em2;
+		em1.RegisterComponentType<Position>();
+		em1.RegisterComponentType<Eater>();
+		em2.RegisterComponentType<Eater>();
+
+		ecs::Entity e1 = em1.NewEntity();
+		ecs::Entity e2 = em2.NewEntity();
+		e1.Assign<Eater>();
+		e2.Assign<Position>(1, 2);
+
+		ASSERT_TRUE(e1.Has<Eater>());
+		ASSERT_FALSE(e1.Has<Position>());
+		ASSERT_TRUE(e2.Has<Position>());
+		ASSERT_FALSE(e2.Has<Eater>());
+		ASSERT_EQ(Position(1, 2), *e2.Get<Position>());
+		ASSERT_NE(em1.CreateComponentMask<Eater>(), em2.CreateComponentMask<Eater>());
+	}
+
 	TEST(EcsBasic, DeleteComponentDoesNotInvalidateOtherComponentHandles)
 	{
 		ecs::EntityManager em;
@@ -394,6 +635,41 @@ namespace test
 		ASSERT_EQ(positionBefore, positionAfter);
 	}
 
+	TEST(EcsBasic, ComponentsOnEntitiesFarApart)
+	{
+		ecs::EntityManager em;
+		em.RegisterComponentType<Position>();
+
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 20000; ++i)
+		{
+			entities.push_back(em.NewEntity());
+		}
+
+		// only a few scattered entities get a component
+		for (int i = 0; i < 20000; i += 4999)
+		{
+			entities[i].Assign<Position>(i, -i);
+		}
+
+		for (int i = 0; i < 20000; ++i)
+		{
+			if (i % 4999 == 0)
+			{
+				ASSERT_TRUE(entities[i].Has<Position>());
+				ASSERT_EQ(Position(i, -i), *entities[i].Get<Position>());
+			}
+			else
+			{
+				ASSERT_FALSE(entities[i].Has<Position>());
+			}
+		}
+
+		entities[0].Remove<Position>();
+		ASSERT_FALSE(entities[0].Has<Position>());
+		ASSERT_EQ(Position(19996, -19996), *entities[19996].Get<Position>());
+	}
+
 	TEST(EcsDestroyAll, DestroysMultipleEntities)
 	{
 		ecs::EntityManager em;
@@ -456,6 +732,87 @@ namespace test
 		em.DestroyAll(); // ensure no exceptions raised
 	}
 
+	TEST(EcsDestroyAll, ComponentsAreRemoved)
+	{
+		ecs::EntityManager em;
+		em.RegisterComponentGroup<Position, Eater>();
+		vector<ecs::Entity::Id> ids = em.CreateMany(10, Position(1, 1), Eater());
+		em.NewEntity().Assign<Position>(2, 2);
+
+		em.DestroyAll();
+
+		for (auto id : ids)
+		{
+			ASSERT_FALSE(em.Valid(id));
+		}
+		for (ecs::Entity e : em.EntitiesWith<Position>())
+		{
+			FAIL() << e << " should not have a Position anymore";
+		}
+
+		ecs::Entity e = em.NewEntity();
+		e.Assign<Position>(3, 3);
+		e.Assign<Eater>();
+
+		int found = 0;
+		em.Each<Position, Eater>([&](ecs::Entity ent, Position &position, Eater &)
+		{
+			ASSERT_EQ(e, ent);
+			ASSERT_EQ(Position(3, 3), position);
+			found++;
+		});
+		ASSERT_EQ(1, found);
+	}
+
+	TEST(EcsDestroyAll, WhileIterating)
+	{
+		ecs::EntityManager em;
+		em.CreateMany(10, Position(1, 1));
+
+		int iterated = 0;
+		for (ecs::Entity e : em.EntitiesWith<Position>())
+		{
+			iterated++;
+			em.DestroyAll();
+			ASSERT_FALSE(e.Valid());
+		}
+		ASSERT_EQ(1, iterated);
+	}
+
+	TEST(EcsDestroyBatch, DestroysEntities)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.CreateMany(10, Position(1, 1));
+
+		vector<ecs::Entity::Id> destroyed = { ids[1], ids[3], ids[5], ids[3] };
+		em.DestroyBatch(destroyed);
+
+		for (size_t i = 0; i < ids.size(); ++i)
+		{
+			bool shouldBeDestroyed = (i == 1 || i == 3 || i == 5);
+			ASSERT_EQ(!shouldBeDestroyed, em.Valid(ids[i]));
+		}
+
+		int found = 0;
+		for (ecs::Entity e : em.EntitiesWith<Position>())
+		{
+			ASSERT_TRUE(e.Valid());
+			found++;
+		}
+		ASSERT_EQ(7, found);
+	}
+
+	TEST(EcsDestroyBatch, InvalidEntityDestroysNothing)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.NewEntities(3);
+		em.Destroy(ids[2]);
+
+		ASSERT_THROW(em.DestroyBatch(ids), std::invalid_argument);
+		ASSERT_TRUE(em.Valid(ids[0]));
+		ASSERT_TRUE(em.Valid(ids[1]));
+	}
+
 	TEST(EcsRecycle, EntitiesGetRecycledAfterManyAreDestroyed)
 	{
 		ecs::EntityManager em;
@@ -504,4 +861,214 @@ namespace test
 
 		ASSERT_FALSE(e.Has<Position>());
 	}
+
+	TEST(EcsRecycle, OldestIndexesAreRecycledFirst)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> destroyed;
+		for (size_t i = 0; i < ECS_ENTITY_RECYCLE_COUNT + 10; ++i)
+		{
+			destroyed.push_back(em.NewEntity().GetId());
+		}
+
+		// destroy out of index order, the free list keeps destruction order
+		std::reverse(destroyed.begin(), destroyed.end());
+		for (ecs::Entity::Id e : destroyed)
+		{
+			em.Destroy(e);
+			ASSERT_FALSE(em.Valid(e));
+			ASSERT_FALSE(em.Valid(ecs::Entity::Id(e.Index(), e.Generation() + 1)));
+		}
+
+		for (size_t i = 0; i <= 10; ++i)
+		{
+			ecs::Entity e = em.NewEntity();
+			ASSERT_EQ(destroyed[i].Index(), e.Index());
+			ASSERT_EQ(destroyed[i].Generation() + 1, e.Generation());
+			ASSERT_TRUE(e.Valid());
+		}
+
+		// below the recycle count so a new index is used
+		ASSERT_EQ(destroyed.front().Index() + 1, em.NewEntity().Index());
+
+		vector<ecs::Entity::Id> many = em.NewEntities(5);
+		ASSERT_EQ(destroyed.front().Index() + 2, many.front().Index());
+		ASSERT_EQ(destroyed.front().Index() + 6, many.back().Index());
+	}
+
+	TEST(EcsBulk, NewEntities)
+	{
+		ecs::EntityManager em;
+		ecs::Entity first = em.NewEntity();
+		vector<ecs::Entity::Id> ids = em.NewEntities(100);
+
+		ASSERT_EQ(100u, ids.size());
+		for (size_t i = 0; i < ids.size(); ++i)
+		{
+			ASSERT_TRUE(em.Valid(ids[i]));
+			ASSERT_EQ(first.Index() + 1 + i, ids[i].Index());
+		}
+
+		ecs::Entity e(&em, ids[50]);
+		e.Assign<Position>(1, 2);
+		ASSERT_EQ(Position(1, 2), *e.Get<Position>());
+		ASSERT_TRUE(em.NewEntities(0).empty());
+	}
+
+	TEST(EcsBulk, NewEntitiesRecyclesIndexes)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.NewEntities(ECS_ENTITY_RECYCLE_COUNT + 10);
+		for (auto id : ids)
+		{
+			em.Destroy(id);
+		}
+
+		vector<ecs::Entity::Id> recycled = em.NewEntities(20);
+		int recycledCount = 0;
+		for (auto id : recycled)
+		{
+			ASSERT_TRUE(em.Valid(id));
+			if (id.Generation() > 0)
+			{
+				recycledCount++;
+			}
+		}
+
+		// indexes are only recycled while enough of them are waiting
+		ASSERT_EQ(11, recycledCount);
+	}
+
+	TEST(EcsBulk, CreateMany)
+	{
+		ecs::EntityManager em;
+		em.NewEntity().Assign<Position>(5, 5);
+
+		vector<ecs::Entity::Id> ids = em.CreateMany(50, Position(1, 2), Eater());
+
+		int found = 0;
+		for (ecs::Entity e : em.EntitiesWith<Position, Eater>())
+		{
+			ASSERT_EQ(Position(1, 2), *e.Get<Position>());
+			found++;
+		}
+		ASSERT_EQ(50, found);
+
+		ecs::Entity(&em, ids[10]).Remove<Position>();
+		ASSERT_FALSE(ecs::Entity(&em, ids[10]).Has<Position>());
+		ASSERT_TRUE(ecs::Entity(&em, ids[11]).Has<Position>());
+	}
+
+	namespace
+	{
+		// can only be moved, holds its value on the heap
+		struct Owned
+		{
+			Owned(int value) : value(new int(value)) {}
+			std::unique_ptr<int> value;
+		};
+
+		// counts how often any instance is copied or moved
+		struct Counted
+		{
+			static int copies;
+			static int moves;
+
+			Counted(int value) : value(value) {}
+			Counted(const Counted &other) : value(other.value) { copies++; }
+			Counted(Counted &&other) noexcept : value(other.value) { moves++; }
+			Counted &operator=(const Counted &other) { value = other.value; copies++; return *this; }
+			Counted &operator=(Counted &&other) noexcept { value = other.value; moves++; return *this; }
+			int value;
+		};
+
+		int Counted::copies = 0;
+		int Counted::moves = 0;
+	}
+
+	TEST(EcsEmplace, MoveOnlyComponent)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 10; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			entities.back().Emplace<Owned>(i);
+		}
+
+		entities[3].Remove<Owned>();
+		entities[5].Destroy();
+		entities[7].Emplace<Owned>(70);
+		entities[3].Assign<Owned>(Owned(30));
+
+		for (int i = 0; i < 10; ++i)
+		{
+			if (i == 5)
+			{
+				continue;
+			}
+			int expected = (i == 3 || i == 7) ? i * 10 : i;
+			ASSERT_EQ(expected, *entities[i].Get<Owned>()->value);
+		}
+	}
+
+	TEST(EcsEmplace, ConstructsOnce)
+	{
+		ecs::EntityManager em;
+		em.RegisterComponentType<Counted>();
+		ecs::Entity e1 = em.NewEntity();
+		ecs::Entity e2 = em.NewEntity();
+		e1.Emplace<Counted>(1);
+		e2.Emplace<Counted>(2);
+		e1.Remove<Counted>();
+
+		// the removed component's slot is reused without assigning over it
+		Counted::copies = 0;
+		Counted::moves = 0;
+		em.Emplace<Counted>(e1.GetId(), 3);
+
+		EXPECT_EQ(0, Counted::copies);
+		EXPECT_EQ(0, Counted::moves);
+		EXPECT_EQ(3, e1.Get<Counted>()->value);
+		EXPECT_EQ(2, e2.Get<Counted>()->value);
+	}
+
+	TEST(EcsEmplace, AssignMovesComponent)
+	{
+		ecs::EntityManager em;
+		em.RegisterComponentType<Counted>();
+		ecs::Entity e = em.NewEntity();
+		e.Assign<Counted>(1);
+
+		Counted::copies = 0;
+		Counted component(2);
+		e.Assign<Counted>(component);
+
+		// only the by-value argument is copied, the replaced component is moved out of the way
+		EXPECT_EQ(1, Counted::copies);
+		EXPECT_EQ(2, e.Get<Counted>()->value);
+	}
+
+	TEST(EcsEmplace, ReplaceFromTheExistingComponent)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+		for (int i = 0; i < 3; ++i)
+		{
+			entities.push_back(em.NewEntity());
+			entities.back().Emplace<Owned>(i);
+		}
+
+		// the argument refers to the component being replaced
+		ecs::Entity e = entities[0];
+		e.Emplace<Owned>(*e.Get<Owned>()->value + 10);
+		e.Emplace<Owned>(std::move(*e.Get<Owned>()));
+		e.Assign<Counted>(5);
+		e.Emplace<Counted>(*e.Get<Counted>());
+
+		ASSERT_EQ(10, *e.Get<Owned>()->value);
+		ASSERT_EQ(5, e.Get<Counted>()->value);
+		ASSERT_EQ(1, *entities[1].Get<Owned>()->value);
+		ASSERT_EQ(2, *entities[2].Get<Owned>()->value);
+	}
 }
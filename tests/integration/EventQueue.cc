@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Damage
+		{
+			Damage(int amount) : amount(amount) {}
+			int amount;
+		};
+
+		struct Heal
+		{
+			Heal(int amount) : amount(amount) {}
+			int amount;
+		};
+	}
+
+	class EcsEventQueue : public ::testing::Test
+	{
+	protected:
+		ecs::EntityManager em;
+		ecs::Entity player1;
+		ecs::Entity player2;
+
+		virtual void SetUp()
+		{
+			player1 = em.NewEntity();
+			player2 = em.NewEntity();
+		}
+	};
+
+	TEST_F(EcsEventQueue, EventsAreDeliveredWhenDispatched)
+	{
+		vector<std::pair<ecs::Entity, int>> received;
+		em.Subscribe<Damage>([&](ecs::Entity e, const Damage &d)
+		{
+			received.push_back(std::make_pair(e, d.amount));
+		});
+
+		int player2Damage = 0;
+		player2.Subscribe<Damage>([&](ecs::Entity, const Damage &d)
+		{
+			player2Damage += d.amount;
+		});
+
+		player1.Enqueue(Damage(1));
+		em.Enqueue(player2.GetId(), Damage(2));
+		player1.Enqueue(Damage(3));
+		ASSERT_TRUE(received.empty());
+
+		em.DispatchQueued<Heal>();
+		ASSERT_TRUE(received.empty());
+
+		em.DispatchQueued<Damage>();
+		ASSERT_EQ(3u, received.size());
+		ASSERT_EQ(std::make_pair(player1, 1), received[0]);
+		ASSERT_EQ(std::make_pair(player2, 2), received[1]);
+		ASSERT_EQ(std::make_pair(player1, 3), received[2]);
+		ASSERT_EQ(2, player2Damage);
+
+		// the queue was emptied
+		em.DispatchAll();
+		ASSERT_EQ(3u, received.size());
+	}
+
+	TEST_F(EcsEventQueue, BatchSubscriber)
+	{
+		int batches = 0;
+		int total = 0;
+		ecs::Subscription sub = em.SubscribeBatch<Damage>(
+			[&](ecs::Span<const std::pair<ecs::Entity, Damage>> events)
+		{
+			batches++;
+			for (auto &event : events)
+			{
+				total += event.second.amount;
+			}
+		});
+
+		for (int i = 1; i <= 100; ++i)
+		{
+			(i % 2 ? player1 : player2).Enqueue(Damage(i));
+		}
+		em.Enqueue(player1.GetId(), Heal(5));
+
+		// Emit() only reaches the regular subscribers
+		player1.Emit(Damage(1000));
+
+		em.DispatchAll();
+		ASSERT_EQ(1, batches);
+		ASSERT_EQ(5050, total);
+
+		sub.Unsubscribe();
+		player1.Enqueue(Damage(1));
+		em.DispatchAll();
+		ASSERT_EQ(1, batches);
+	}
+
+	TEST_F(EcsEventQueue, EventsOfDestroyedEntitiesAreDropped)
+	{
+		int received = 0;
+		em.Subscribe<Damage>([&](ecs::Entity e, const Damage &)
+		{
+			received++;
+			// player2's event is after this one
+			if (e == player1)
+			{
+				player2.Destroy();
+			}
+		});
+
+		ecs::Entity doomed = em.NewEntity();
+		doomed.Enqueue(Damage(1));
+		player1.Enqueue(Damage(1));
+		player2.Enqueue(Damage(1));
+		doomed.Destroy();
+
+		em.DispatchAll();
+		ASSERT_EQ(1, received);
+	}
+
+	TEST_F(EcsEventQueue, EventsQueuedWhileDispatchingWaitForTheNextDispatch)
+	{
+		int damaged = 0;
+		int healed = 0;
+		em.Subscribe<Heal>([&](ecs::Entity, const Heal &) { healed++; });
+		em.Subscribe<Damage>([&](ecs::Entity e, const Damage &d)
+		{
+			damaged++;
+			if (d.amount > 0)
+			{
+				e.Enqueue(Damage(d.amount - 1));
+				e.Enqueue(Heal(1));
+			}
+		});
+
+		player1.Enqueue(Damage(2));
+		em.DispatchQueued<Damage>();
+		ASSERT_EQ(1, damaged);
+		ASSERT_EQ(0, healed);
+
+		// Heal was first queued after Damage so it is dispatched after it and
+		// also gets the Heal queued by this dispatch of Damage
+		em.DispatchAll();
+		ASSERT_EQ(2, damaged);
+		ASSERT_EQ(2, healed);
+
+		em.DispatchAll();
+		ASSERT_EQ(3, damaged);
+		ASSERT_EQ(2, healed);
+		em.DispatchAll();
+		ASSERT_EQ(3, damaged);
+	}
+}
@@ -304,6 +304,27 @@ namespace test
 			<< "Entity destruction event not seen by subscriber";
 	}
 
+	TEST_F(EcsEvents, DestroyBatchEmitsEntityDestructionEvents)
+	{
+		Gravedigger gravedigger;
+		em.Subscribe<ecs::EntityDestruction>(std::ref(gravedigger));
+
+		vector<ecs::Entity::Id> ids = { player1.GetId(), player2.GetId() };
+		em.DestroyBatch(ids);
+		ASSERT_EQ(2, gravedigger.gravesDug);
+	}
+
+	TEST_F(EcsEvents, DestroyAllEmitsEntityDestructionEvents)
+	{
+		Gravedigger gravedigger;
+		player2.Subscribe<ecs::EntityDestruction>(std::ref(gravedigger));
+
+		em.DestroyAll();
+		ASSERT_EQ(1, gravedigger.gravesDug);
+		ASSERT_FALSE(player1.Valid());
+		ASSERT_FALSE(player2.Valid());
+	}
+
 	TEST_F(EcsEvents, UnsubscribeFromSingleEntityEvent)
 	{
 		HitReceiver hitReceiver;
@@ -363,6 +384,187 @@ namespace test
 		EXPECT_TRUE(triggered2);
 	}
 
+	TEST_F(EcsEvents, UnsubscribeReleasesCallback)
+	{
+		std::shared_ptr<int> captured = std::make_shared<int>(0);
+		ecs::Subscription allSub = em.Subscribe<bool>([captured](ecs::Entity, bool) { (*captured)++; });
+		ecs::Subscription entitySub = player1.Subscribe<bool>([captured](ecs::Entity, bool) { (*captured)++; });
+		player1.Emit(true);
+		ASSERT_EQ(3, captured.use_count());
+
+		allSub.Unsubscribe();
+		entitySub.Unsubscribe();
+		ASSERT_EQ(1, captured.use_count());
+		ASSERT_EQ(2, *captured);
+	}
+
+	TEST_F(EcsEvents, SubscribeDuringEmitIsCalledByTheNextEmit)
+	{
+		int outer = 0;
+		int inner = 0;
+		em.Subscribe<bool>([&](ecs::Entity, bool)
+		{
+			outer++;
+			em.Subscribe<bool>([&](ecs::Entity, bool) { inner++; });
+		});
+
+		player1.Emit(true);
+		ASSERT_EQ(1, outer);
+		ASSERT_EQ(0, inner);
+
+		player1.Emit(true);
+		ASSERT_EQ(2, outer);
+		ASSERT_EQ(1, inner);
+	}
+
+	TEST_F(EcsEvents, DestroyEntityFromItsOwnSubscriber)
+	{
+		int called = 0;
+		ecs::Subscription sub = player1.Subscribe<bool>([&](ecs::Entity e, bool)
+		{
+			called++;
+			e.Destroy();
+		});
+
+		player1.Emit(true);
+		ASSERT_EQ(1, called);
+		ASSERT_FALSE(player1.Valid());
+		ASSERT_FALSE(sub.IsActive());
+	}
+
+	TEST_F(EcsEvents, ResubscribeAfterManyUnsubscribes)
+	{
+		int called = 0;
+		for (int i = 0; i < 100; ++i)
+		{
+			ecs::Subscription sub = em.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+			sub.Unsubscribe();
+		}
+		ecs::Subscription sub = em.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+
+		player1.Emit(true);
+		player2.Emit(true);
+		ASSERT_EQ(2, called);
+		ASSERT_TRUE(sub.IsActive());
+	}
+
+	TEST_F(EcsEvents, SeveralEventTypesOnOneEntity)
+	{
+		int hits = 0;
+		int flags = 0;
+		int numbers = 0;
+		player1.Subscribe<Hit>([&](ecs::Entity, const Hit &) { hits++; });
+		player1.Subscribe<bool>([&](ecs::Entity, bool) { flags++; });
+		player1.Subscribe<int>([&](ecs::Entity, int) { numbers++; });
+		player1.Subscribe<bool>([&](ecs::Entity, bool) { flags++; });
+
+		player1.Emit(true);
+		player1.Emit(3);
+		player2.Emit(true);
+		player2.Emit(Hit(player2.Get<Weapon>()));
+
+		ASSERT_EQ(0, hits);
+		ASSERT_EQ(2, flags);
+		ASSERT_EQ(1, numbers);
+	}
+
+	TEST_F(EcsEvents, EntitySubscribersAreNotInheritedByRecycledIndexes)
+	{
+		int called = 0;
+		ecs::Subscription sub = player1.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+		ecs::Entity::Id destroyed = player1.GetId();
+		player1.Destroy();
+		ASSERT_FALSE(sub.IsActive());
+
+		// enough destroyed indexes for the free list to be used
+		vector<ecs::Entity::Id> ids = em.NewEntities(ECS_ENTITY_RECYCLE_COUNT);
+		em.DestroyBatch(ids);
+		ecs::Entity recycled = em.NewEntity();
+		ASSERT_EQ(destroyed.Index(), recycled.GetId().Index());
+
+		recycled.Emit(true);
+		em.Emit(destroyed, true);
+		ASSERT_EQ(0, called);
+
+		recycled.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+		recycled.Emit(true);
+		em.Emit(destroyed, true);
+		ASSERT_EQ(1, called);
+	}
+
+	TEST_F(EcsEvents, SubscribeAgainAfterEntitySubscribersAreDestroyed)
+	{
+		int called = 0;
+		player1.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+		player2.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+		player1.Destroy();
+		player2.Destroy();
+
+		ecs::Entity player3 = em.NewEntity();
+		player3.Emit(true);
+		ASSERT_EQ(0, called);
+
+		em.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+		player3.Emit(true);
+		ASSERT_EQ(1, called);
+
+		player3.Subscribe<bool>([&](ecs::Entity, bool) { called++; });
+		player3.Emit(true);
+		ASSERT_EQ(3, called);
+	}
+
+	TEST_F(EcsEvents, SubscribeAgainAfterUnsubscribing)
+	{
+		int all = 0;
+		int flags = 0;
+		int numbers = 0;
+		ecs::Subscription allSub = em.Subscribe<bool>([&](ecs::Entity, bool) { all++; });
+		ecs::Subscription flagSub = player1.Subscribe<bool>([&](ecs::Entity, bool) { flags++; });
+		player1.Subscribe<int>([&](ecs::Entity, int) { numbers++; });
+
+		allSub.Unsubscribe();
+		flagSub.Unsubscribe();
+		player1.Emit(true);
+		player1.Emit(true);
+		player1.Emit(3);
+		ASSERT_EQ(0, all);
+		ASSERT_EQ(0, flags);
+		ASSERT_EQ(1, numbers);
+
+		// the unsubscribed signals were forgotten by the Emit() calls above
+		player1.Subscribe<Hit>([&](ecs::Entity, const Hit &) { flags++; });
+		player1.Emit(Hit(player1.Get<Weapon>()));
+		player1.Emit(true);
+		ASSERT_EQ(1, flags);
+
+		em.Subscribe<bool>([&](ecs::Entity, bool) { all++; });
+		player1.Subscribe<bool>([&](ecs::Entity, bool) { flags++; });
+		player1.Emit(true);
+		player2.Emit(true);
+		player1.Emit(3);
+		ASSERT_EQ(2, all);
+		ASSERT_EQ(2, flags);
+		ASSERT_EQ(2, numbers);
+	}
+
+	TEST_F(EcsEvents, DestroyAfterUnsubscribingFromEveryEntityEvent)
+	{
+		int destroyed = 0;
+		ecs::Subscription sub = player1.Subscribe<ecs::EntityDestruction>(
+			[&](ecs::Entity, const ecs::EntityDestruction &) { destroyed++; });
+		sub.Unsubscribe();
+
+		player1.Emit(ecs::EntityDestruction());
+		em.DestroyAll();
+		ASSERT_EQ(0, destroyed);
+		ASSERT_FALSE(player1.Valid());
+
+		ecs::Entity e = em.NewEntity();
+		e.Subscribe<ecs::EntityDestruction>([&](ecs::Entity, const ecs::EntityDestruction &) { destroyed++; });
+		em.DestroyAll();
+		ASSERT_EQ(1, destroyed);
+	}
+
 	TEST_F(EcsNonEntityEvents, SingleReceive)
 	{
 		bool called = false;
@@ -403,4 +605,33 @@ namespace test
 		EXPECT_EQ(1, timesCalled);
 		EXPECT_FALSE(sub.IsActive());
 	}
+
+	TEST_F(EcsNonEntityEvents, SubscribeAgainAfterUnsubscribing)
+	{
+		int timesCalled = 0;
+		ecs::Subscription sub = em.Subscribe<bool>([&](bool) { timesCalled++; });
+		sub.Unsubscribe();
+		em.Emit(true);
+		em.Emit(true);
+		EXPECT_EQ(0, timesCalled);
+
+		em.Subscribe<bool>([&](bool) { timesCalled++; });
+		em.Emit(true);
+		EXPECT_EQ(1, timesCalled);
+	}
+
+	TEST_F(EcsNonEntityEvents, SameTypeAsEntityEvents)
+	{
+		int entityEvents = 0;
+		int nonEntityEvents = 0;
+		em.Subscribe<bool>([&](ecs::Entity, bool) { entityEvents++; });
+		em.Emit(true);
+		EXPECT_EQ(0, nonEntityEvents);
+
+		em.Subscribe<bool>([&](bool) { nonEntityEvents++; });
+		em.Emit(true);
+		em.NewEntity().Emit(true);
+		EXPECT_EQ(1, entityEvents);
+		EXPECT_EQ(1, nonEntityEvents);
+	}
 }
@@ -0,0 +1,235 @@
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Counter
+		{
+			Counter() : visits(0) {}
+			int visits;
+		};
+
+		struct Value
+		{
+			Value(int value) : value(value) {}
+			int value;
+		};
+	}
+
+	class EcsParallelEach : public ::testing::Test
+	{
+	protected:
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities;
+
+		virtual void SetUp()
+		{
+			// more threads than cores is fine, this makes sure work is actually
+			// split between threads no matter what machine the tests run on
+			em.SetWorkerThreadCount(3);
+
+			for (int i = 0; i < 10000; ++i)
+			{
+				ecs::Entity e = em.NewEntity();
+				e.Assign<Counter>();
+				if (i % 3 == 0)
+				{
+					e.Assign<Value>(i);
+				}
+				entities.push_back(e);
+			}
+		}
+
+		void expectVisitedOnce()
+		{
+			for (ecs::Entity e : entities)
+			{
+				int expected = e.Has<Value>() ? 1 : 0;
+				ASSERT_EQ(expected, e.Get<Counter>()->visits) << e;
+			}
+		}
+	};
+
+	TEST_F(EcsParallelEach, VisitsEveryMatchOnce)
+	{
+		em.ParallelEach<Counter, Value>([](ecs::Entity, Counter &counter, Value &)
+		{
+			counter.visits++;
+		}, 64);
+
+		expectVisitedOnce();
+	}
+
+	TEST_F(EcsParallelEach, VisitsEveryGroupMatchOnce)
+	{
+		em.RegisterComponentGroup<Counter, Value>();
+		entities[0].Remove<Value>();
+		entities[1].Assign<Value>(-1);
+
+		std::atomic<int> visited(0);
+		em.ParallelEach<Value, Counter>([&](ecs::Entity, Value &, Counter &counter)
+		{
+			counter.visits++;
+			visited++;
+		}, 100);
+
+		expectVisitedOnce();
+		ASSERT_EQ(3334, visited.load());
+	}
+
+	TEST_F(EcsParallelEach, GrainSizeLargerThanEntityCount)
+	{
+		em.ParallelEach<Counter, Value>([](ecs::Entity, Counter &counter, Value &)
+		{
+			counter.visits++;
+		}, 1000000);
+
+		expectVisitedOnce();
+	}
+
+	TEST_F(EcsParallelEach, NoWorkerThreads)
+	{
+		em.SetWorkerThreadCount(0);
+		em.ParallelEach<Counter, Value>([](ecs::Entity, Counter &counter, Value &)
+		{
+			counter.visits++;
+		}, 7);
+
+		expectVisitedOnce();
+	}
+
+	TEST_F(EcsParallelEach, StructuralChangesAreRejected)
+	{
+		ASSERT_THROW(em.ParallelEach<Value>([](ecs::Entity e, Value &)
+		{
+			e.Remove<Value>();
+		}), std::runtime_error);
+
+		ASSERT_THROW(em.ParallelEach<Value>([&](ecs::Entity, Value &)
+		{
+			em.NewEntity();
+		}), std::runtime_error);
+
+		ASSERT_THROW(em.ParallelEach<Value>([&](ecs::Entity, Value &)
+		{
+			em.Each<Counter>([](ecs::Entity, Counter &) {});
+		}), std::runtime_error);
+
+		// nothing changed and changes are allowed again afterwards
+		for (ecs::Entity e : entities)
+		{
+			ASSERT_EQ(e.Index() % 3 == 1, e.Has<Value>());
+		}
+		entities[0].Remove<Value>();
+		ASSERT_FALSE(entities[0].Has<Value>());
+	}
+
+	TEST_F(EcsParallelEach, ExceptionsAreRethrown)
+	{
+		std::atomic<int> visited(0);
+		ASSERT_THROW(em.ParallelEach<Counter>([&](ecs::Entity e, Counter &)
+		{
+			visited++;
+			if (e == entities[5000])
+			{
+				throw std::invalid_argument("test");
+			}
+		}, 10), std::invalid_argument);
+
+		// the remaining work is skipped
+		ASSERT_LT(visited.load(), 10000);
+
+		em.ParallelEach<Counter, Value>([](ecs::Entity, Counter &counter, Value &)
+		{
+			counter.visits++;
+		});
+		expectVisitedOnce();
+	}
+
+	TEST_F(EcsParallelEach, EventsAreDeliveredInSerialOrder)
+	{
+		vector<int> serial;
+		ecs::Subscription sub = em.Subscribe<Value>([&](ecs::Entity, const Value &v)
+		{
+			serial.push_back(v.value);
+		});
+		em.Each<Value>([&](ecs::Entity e, Value &value)
+		{
+			e.Emit(value);
+		});
+		sub.Unsubscribe();
+
+		vector<int> parallel;
+		int entityEvents = 0;
+		int globalEvents = 0;
+		em.Subscribe<Value>([&](ecs::Entity, const Value &v)
+		{
+			parallel.push_back(v.value);
+		});
+		entities[3].Subscribe<Value>([&](ecs::Entity, const Value &) { entityEvents++; });
+		em.Subscribe<Counter>([&](const Counter &) { globalEvents++; });
+
+		em.ParallelEach<Value>([&](ecs::Entity e, Value &value)
+		{
+			e.Emit(value);
+			em.Emit(Counter());
+		}, 16);
+
+		ASSERT_EQ(3334u, serial.size());
+		ASSERT_EQ(serial, parallel);
+		ASSERT_EQ(1, entityEvents);
+		ASSERT_EQ(3334, globalEvents);
+	}
+
+	TEST_F(EcsParallelEach, EventsCanBeQueued)
+	{
+		int total = 0;
+		em.SubscribeBatch<Value>([&](ecs::Span<const std::pair<ecs::Entity, Value>> events)
+		{
+			for (auto &event : events)
+			{
+				total += event.second.value;
+			}
+		});
+
+		int expected = 0;
+		em.ParallelEach<Value>([&](ecs::Entity e, Value &value)
+		{
+			e.Enqueue(value);
+		}, 16);
+		em.Each<Value>([&](ecs::Entity, Value &value)
+		{
+			expected += value.value;
+		});
+
+		ASSERT_EQ(0, total);
+		em.DispatchAll();
+		ASSERT_EQ(expected, total);
+	}
+
+	TEST_F(EcsParallelEach, EventsAreDroppedWhenACallbackThrows)
+	{
+		int received = 0;
+		em.Subscribe<Value>([&](ecs::Entity, const Value &) { received++; });
+
+		ASSERT_THROW(em.ParallelEach<Value>([&](ecs::Entity e, Value &value)
+		{
+			e.Emit(value);
+			if (e == entities[3])
+			{
+				throw std::invalid_argument("test");
+			}
+		}), std::invalid_argument);
+		ASSERT_EQ(0, received);
+
+		ASSERT_THROW(em.ParallelEach<Value>([&](ecs::Entity, Value &)
+		{
+			em.Subscribe<Value>([](ecs::Entity, const Value &) {});
+		}), std::runtime_error);
+	}
+}
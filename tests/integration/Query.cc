@@ -0,0 +1,188 @@
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Position
+		{
+			Position() {}
+			Position(int x, int y) : x(x), y(y) {}
+			int x;
+			int y;
+		};
+
+		struct Velocity
+		{
+			Velocity() {}
+			Velocity(int dx, int dy) : dx(dx), dy(dy) {}
+			int dx;
+			int dy;
+		};
+	}
+
+	TEST(EcsQuery, CreatedBeforeComponentsExist)
+	{
+		ecs::EntityManager em;
+		auto query = em.CreateQuery<Position, Velocity>();
+
+		ecs::Entity e1 = em.NewEntity();
+		e1.Assign<Position>(1, 1);
+		e1.Assign<Velocity>(2, 3);
+		ecs::Entity e2 = em.NewEntity();
+		e2.Assign<Position>(5, 5);
+
+		int found = 0;
+		query.Each([&](ecs::Entity e, Position &position, Velocity &velocity)
+		{
+			ASSERT_EQ(e1, e);
+			position.x += velocity.dx;
+			position.y += velocity.dy;
+			found++;
+		});
+
+		ASSERT_EQ(1, found);
+		ASSERT_EQ(3, e1.Get<Position>()->x);
+		ASSERT_EQ(4, e1.Get<Position>()->y);
+		ASSERT_EQ((em.CreateComponentMask<Position, Velocity>()), query.Mask());
+	}
+
+	TEST(EcsQuery, ReusedAsPoolSizesChange)
+	{
+		ecs::EntityManager em;
+		ecs::Query<Position, Velocity> query(em);
+		vector<ecs::Entity> entities;
+
+		for (int round = 0; round < 4; ++round)
+		{
+			// alternate which pool is the smallest
+			for (int i = 0; i < 100; ++i)
+			{
+				ecs::Entity e = em.NewEntity();
+				if (round % 2 == 0)
+				{
+					e.Assign<Position>(i, i);
+				}
+				else
+				{
+					e.Assign<Velocity>(i, i);
+				}
+				entities.push_back(e);
+			}
+			entities[round].Assign<Position>(0, 0);
+			entities[round].Assign<Velocity>(0, 0);
+
+			std::unordered_map<ecs::Entity, int> found;
+			for (ecs::Entity e : query.Entities())
+			{
+				found[e]++;
+			}
+
+			size_t eachFound = 0;
+			query.Each([&](ecs::Entity e, Position &, Velocity &)
+			{
+				ASSERT_EQ(1, found[e]);
+				eachFound++;
+			});
+
+			ASSERT_EQ(static_cast<size_t>(round + 1), found.size());
+			ASSERT_EQ(found.size(), eachFound);
+		}
+	}
+
+	TEST(EcsQuery, DriverChangesWhenAnotherPoolShrinks)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity> entities = { em.NewEntity(), em.NewEntity(), em.NewEntity() };
+		for (ecs::Entity e : entities)
+		{
+			e.Assign<Position>(0, 0);
+		}
+		for (int i = 0; i < 97; ++i)
+		{
+			em.NewEntity().Assign<Position>(0, 0);
+		}
+
+		// velocities are stored in the opposite order of positions
+		for (int i = 2; i >= 0; --i)
+		{
+			entities[i].Assign<Velocity>(0, 0);
+		}
+		vector<ecs::Entity> velocityOnly;
+		for (int i = 0; i < 200; ++i)
+		{
+			velocityOnly.push_back(em.NewEntity());
+			velocityOnly.back().Assign<Velocity>(0, 0);
+		}
+
+		auto query = em.CreateQuery<Position, Velocity>();
+		vector<ecs::Entity> visited;
+		auto visit = [&](ecs::Entity e, Position &, Velocity &) { visited.push_back(e); };
+
+		// the positions are iterated over while there are fewer of them
+		query.Each(visit);
+		ASSERT_EQ(entities, visited);
+
+		// only the velocity pool changes size
+		for (ecs::Entity e : velocityOnly)
+		{
+			e.Remove<Velocity>();
+		}
+
+		visited.clear();
+		query.Each(visit);
+		ASSERT_EQ(vector<ecs::Entity>(entities.rbegin(), entities.rend()), visited);
+	}
+
+	TEST(EcsQuery, ParallelEach)
+	{
+		ecs::EntityManager em;
+		em.SetWorkerThreadCount(2);
+		auto query = em.CreateQuery<Position>();
+
+		for (int i = 0; i < 1000; ++i)
+		{
+			em.NewEntity().Assign<Position>(i, 0);
+		}
+
+		query.ParallelEach([](ecs::Entity, Position &position)
+		{
+			position.y = position.x * 2;
+		}, 16);
+
+		for (ecs::Entity e : query.Entities())
+		{
+			auto position = e.Get<Position>();
+			ASSERT_EQ(position->x * 2, position->y);
+		}
+	}
+
+	TEST(EcsQuery, UsesComponentGroup)
+	{
+		ecs::EntityManager em;
+		auto query = em.CreateQuery<Velocity, Position>();
+
+		for (int i = 0; i < 20; ++i)
+		{
+			ecs::Entity e = em.NewEntity();
+			e.Assign<Position>(i, i);
+			if (i % 4 == 0)
+			{
+				e.Assign<Velocity>(i, i);
+			}
+		}
+		em.RegisterComponentGroup<Position, Velocity>();
+
+		int found = 0;
+		query.Each([&](ecs::Entity, Velocity &velocity, Position &position)
+		{
+			ASSERT_EQ(velocity.dx, position.x);
+			found++;
+		});
+		ASSERT_EQ(5, found);
+	}
+}
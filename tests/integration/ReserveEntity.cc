@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Ecs.hh"
+
+namespace test
+{
+	namespace
+	{
+		struct Bullet
+		{
+			Bullet(int damage) : damage(damage) {}
+			int damage;
+		};
+	}
+
+	TEST(EcsReserveEntity, ReservedEntitiesBecomeValidWhenFlushed)
+	{
+		ecs::EntityManager em;
+		ecs::Entity existing = em.NewEntity();
+
+		ecs::Entity::Id a = em.ReserveEntity();
+		ecs::Entity::Id b = em.ReserveEntity();
+		ASSERT_NE(a, b);
+		ASSERT_NE(existing.GetId(), a);
+
+		em.FlushReservedEntities();
+		ASSERT_TRUE(em.Valid(a));
+		ASSERT_TRUE(em.Valid(b));
+
+		ecs::Entity(&em, a).Assign<Bullet>(5);
+		ASSERT_EQ(5, ecs::Entity(&em, a).Get<Bullet>()->damage);
+
+		// NewEntity() flushes reservations before picking an index
+		ecs::Entity::Id c = em.ReserveEntity();
+		ecs::Entity d = em.NewEntity();
+		ASSERT_TRUE(em.Valid(c));
+		ASSERT_NE(c, d.GetId());
+	}
+
+	TEST(EcsReserveEntity, ReserveFromManyThreads)
+	{
+		const size_t threadCount = 4;
+		const size_t perThread = 5000;
+		ecs::EntityManager em;
+
+		std::mutex mutex;
+		vector<ecs::Entity::Id> reserved;
+		vector<std::thread> threads;
+		for (size_t t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&]()
+			{
+				vector<ecs::Entity::Id> mine;
+				for (size_t i = 0; i < perThread; ++i)
+				{
+					mine.push_back(em.ReserveEntity());
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				reserved.insert(reserved.end(), mine.begin(), mine.end());
+			});
+		}
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+
+		em.FlushReservedEntities();
+		std::sort(reserved.begin(), reserved.end());
+		ASSERT_EQ(reserved.end(), std::unique(reserved.begin(), reserved.end()));
+		ASSERT_EQ(threadCount * perThread, reserved.size());
+		for (ecs::Entity::Id e : reserved)
+		{
+			ASSERT_TRUE(em.Valid(e)) << e;
+		}
+	}
+
+	TEST(EcsReserveEntity, ReserveFromParallelEach)
+	{
+		ecs::EntityManager em;
+		em.SetWorkerThreadCount(3);
+		for (int i = 0; i < 1000; ++i)
+		{
+			em.NewEntity().Assign<Bullet>(i);
+		}
+
+		std::mutex mutex;
+		vector<std::pair<ecs::Entity::Id, int> > spawned;
+		em.ParallelEach<Bullet>([&](ecs::Entity, Bullet &bullet)
+		{
+			ecs::Entity::Id e = em.ReserveEntity();
+			std::lock_guard<std::mutex> lock(mutex);
+			spawned.push_back(std::make_pair(e, bullet.damage));
+		}, 64);
+
+		em.FlushReservedEntities();
+		ASSERT_EQ(1000u, spawned.size());
+		for (auto &pair : spawned)
+		{
+			ecs::Entity(&em, pair.first).Assign<Bullet>(pair.second);
+		}
+
+		int count = 0;
+		em.Each<Bullet>([&](ecs::Entity, Bullet &) { count++; });
+		ASSERT_EQ(2000, count);
+	}
+
+	TEST(EcsReserveEntity, ReservedEntitiesReuseIndexes)
+	{
+		ecs::EntityManager em;
+		vector<ecs::Entity::Id> ids = em.NewEntities(ECS_ENTITY_RECYCLE_COUNT + 100);
+		for (ecs::Entity::Id e : ids)
+		{
+			em.Destroy(e);
+		}
+
+		// the first burst sets how many free indexes are kept for the next one
+		for (int i = 0; i < 50; ++i)
+		{
+			em.ReserveEntity();
+		}
+		em.FlushReservedEntities();
+
+		for (int i = 0; i < 50; ++i)
+		{
+			ecs::Entity::Id e = em.ReserveEntity();
+			ASSERT_EQ(ids[i].Index(), e.Index());
+			ASSERT_EQ(ids[i].Generation() + 1, e.Generation());
+		}
+		em.FlushReservedEntities();
+		ASSERT_TRUE(em.Valid(ecs::Entity::Id(ids[0].Index(), ids[0].Generation() + 1)));
+
+		// reused indexes are not handed out again by NewEntity()
+		ASSERT_NE(ids[0].Index(), em.NewEntity().Index());
+	}
+
+	TEST(EcsReserveEntity, ReservedEntitiesAreNotValidUntilFlushed)
+	{
+		ecs::EntityManager em;
+		ecs::Entity::Id e = em.ReserveEntity();
+		ASSERT_FALSE(em.Valid(e));
+
+		em.FlushReservedEntities();
+		ASSERT_TRUE(em.Valid(e));
+	}
+
+	TEST(EcsReserveEntity, CommandBufferFlushFlushesReservedEntities)
+	{
+		ecs::EntityManager em;
+		ecs::CommandBuffer buf;
+
+		ecs::Entity::Id e = em.ReserveEntity();
+		buf.Assign<Bullet>(e, 3);
+		em.Flush(buf);
+
+		ASSERT_TRUE(em.Valid(e));
+		ASSERT_EQ(3, ecs::Entity(&em, e).Get<Bullet>()->damage);
+	}
+
+#ifdef GLOMERATE_32BIT_ENTITIES
+	TEST(EcsReserveEntity, ReserveThrowsWhenOutOfIndexes)
+	{
+		ecs::EntityManager em;
+
+		// every index but the NULL entity's and the one marking the end of the free list
+		size_t available = ecs::Entity::Id::INDEX_MASK - 1;
+		for (size_t i = 1; i < available; ++i)
+		{
+			em.ReserveEntity();
+		}
+		ASSERT_THROW(em.ReserveEntity(), std::runtime_error);
+		ASSERT_THROW(em.ReserveEntity(), std::runtime_error);
+	}
+#endif
+}
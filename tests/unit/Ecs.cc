@@ -16,4 +16,121 @@ namespace test
 		ASSERT_EQ(8u, sizeof(ecs::Entity::Id().Index()));
 #endif
 	}
+
+	TEST(ComponentMask, SetAndTestBits)
+	{
+		const size_t last = ecs::ComponentMask::BITS - 1;
+		ecs::ComponentMask mask;
+		ASSERT_TRUE(mask.none());
+
+		mask.set(0).set(last);
+		ASSERT_TRUE(mask.test(0));
+		ASSERT_TRUE(mask[last]);
+		ASSERT_FALSE(mask[1]);
+		ASSERT_EQ(2u, mask.count());
+		ASSERT_EQ((uint64)1, mask.Word(0) & 1);
+		ASSERT_EQ((uint64)1, mask.Word(last / 64) >> (last % 64));
+		ASSERT_THROW(mask.set(last + 1), std::out_of_range);
+
+		mask.reset(0);
+		ASSERT_FALSE(mask.test(0));
+		ASSERT_TRUE(mask.any());
+		ASSERT_TRUE(mask.reset().none());
+	}
+
+	TEST(ComponentMask, Contains)
+	{
+		const size_t last = ecs::ComponentMask::BITS - 1;
+		ecs::ComponentMask entity;
+		entity.set(1).set(5).set(last);
+
+		ecs::ComponentMask query;
+		ASSERT_TRUE(entity.Contains(query));
+		query.set(5).set(last);
+		ASSERT_TRUE(entity.Contains(query));
+		ASSERT_EQ(query, entity & query);
+
+		query.set(2);
+		ASSERT_FALSE(entity.Contains(query));
+		ASSERT_NE(query, entity & query);
+		ASSERT_EQ(4u, (entity | query).count());
+	}
+
+	TEST(MaskFilter, FilterMasks)
+	{
+		uint64 masks[ecs::MASK_FILTER_BLOCK];
+		uint64 expected = 0;
+		for (size_t i = 0; i < ecs::MASK_FILTER_BLOCK; ++i)
+		{
+			masks[i] = i * 0x9E3779B97F4A7C15ull;
+			if ((masks[i] & 0x5) == 0x5)
+			{
+				expected |= (uint64)1 << i;
+			}
+		}
+
+		ASSERT_EQ(expected, ecs::FilterMasks(masks, ecs::MASK_FILTER_BLOCK, 0x5));
+
+		// partial blocks only set the bits of the masks that were tested
+		for (size_t count : { 0, 1, 3, 5, 63 })
+		{
+			uint64 countBits = count == 0 ? 0 : ((uint64)1 << count) - 1;
+			ASSERT_EQ(expected & countBits, ecs::FilterMasks(masks, count, 0x5)) << count;
+		}
+
+		ASSERT_EQ(~(uint64)0, ecs::FilterMasks(masks, ecs::MASK_FILTER_BLOCK, 0));
+	}
+
+	TEST(MaskFilter, LowestSetBit)
+	{
+		ASSERT_EQ(0u, ecs::LowestSetBit(1));
+		ASSERT_EQ(5u, ecs::LowestSetBit(0x60));
+		ASSERT_EQ(63u, ecs::LowestSetBit((uint64)1 << 63));
+	}
+
+	TEST(Signal, DisconnectDuringCall)
+	{
+		ecs::Signal<void(int)> signal;
+		ASSERT_TRUE(signal.empty());
+
+		int total = 0;
+		ecs::SignalConnection second;
+		ecs::SignalConnection first = signal.connect([&](int i)
+		{
+			total += i;
+			second.disconnect();
+		});
+		second = signal.connect([&](int i) { total += 10 * i; });
+		signal.connect([&](int i) { total += 100 * i; });
+
+		signal(1);
+		ASSERT_EQ(101, total);
+		ASSERT_TRUE(first.connected());
+		ASSERT_FALSE(second.connected());
+
+		signal.disconnect_all_slots();
+		ASSERT_TRUE(signal.empty());
+		ASSERT_FALSE(first.connected());
+		signal(1);
+		ASSERT_EQ(101, total);
+	}
+
+	TEST(Signal, DisconnectReleasesCallback)
+	{
+		ecs::Signal<void(int)> signal;
+		std::shared_ptr<int> captured = std::make_shared<int>(0);
+
+		ecs::SignalConnection outside = signal.connect([captured](int i) { *captured += i; });
+		ecs::SignalConnection inside;
+		inside = signal.connect([captured, &inside](int) { inside.disconnect(); });
+		ASSERT_EQ(3, captured.use_count());
+
+		// the running callback is only destroyed once the call is done
+		signal(1);
+		ASSERT_EQ(2, captured.use_count());
+
+		outside.disconnect();
+		ASSERT_EQ(1, captured.use_count());
+		ASSERT_EQ(1, *captured);
+	}
 }